@@ -0,0 +1,73 @@
+/****************************************************************************
+ *
+ * camera_aravis
+ *
+ * Copyright © 2022 Fraunhofer IOSB and contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+
+#ifndef CAMERA_ARAVIS_CAMERA_ARAVIS_LISTENER_NODELET
+#define CAMERA_ARAVIS_CAMERA_ARAVIS_LISTENER_NODELET
+
+#include <memory>
+#include <string>
+
+#include <ros/ros.h>
+#include <nodelet/nodelet.h>
+#include <sensor_msgs/Image.h>
+#include <image_transport/image_transport.h>
+#include <camera_info_manager/camera_info_manager.h>
+
+#include <camera_aravis/camera_buffer_pool.h>
+#include <camera_aravis/conversion_utils.h>
+
+#include <camera_aravis_internal/gvsp_receiver.h>
+
+namespace camera_aravis {
+
+    // Read-only receiver of a multicast GigE Vision stream.
+    //
+    // A CameraAravisNodelet with multicast_address set owns the camera and sends its stream to the multicast group.
+    // Any number of listener nodelets, on any host of the network, join the group and convert and publish the images
+    // locally, without a camera connection of their own. The image format is taken from the stream, except for the
+    // name of the pixel format, which has to be given as parameter.
+    class CameraAravisListenerNodelet : public nodelet::Nodelet {
+        public:
+        CameraAravisListenerNodelet() {};
+        virtual ~CameraAravisListenerNodelet();
+
+        private:
+        virtual void onInit() override;
+
+        void frameReceived(internal::GvspReceiver::Frame& frame);
+
+        std::string frame_id_ = "";
+        std::string pixel_format_ = "";
+        bool use_ptp_stamp_ = false;
+        ConversionFunction conversion_function_;
+
+        std::unique_ptr<camera_info_manager::CameraInfoManager> camera_info_manager_;
+        image_transport::CameraPublisher camera_publisher_;
+        CameraBufferPool::Ptr image_pool_;  // recycled images, the receiver gets back a buffer of their size
+        std::unique_ptr<internal::GvspReceiver> receiver_;
+    };
+
+}  // end namespace camera_aravis
+
+#endif
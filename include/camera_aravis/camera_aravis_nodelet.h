@@ -37,6 +37,7 @@ extern "C" {
 #include <cctype>
 #include <memory>
 #include <atomic>
+#include <mutex>
 #include <thread>
 #include <chrono>
 #include <unordered_map>
@@ -62,6 +63,11 @@ extern "C" {
 #include <camera_aravis/CameraAravisConfig.h>
 #include <camera_aravis/CameraAutoInfo.h>
 #include <camera_aravis/ExtendedCameraInfo.h>
+#include <camera_aravis/FeatureChanges.h>
+#include <camera_aravis/FrameSet.h>
+#include <camera_aravis/FrameTiming.h>
+#include <camera_aravis/ShmImage.h>
+#include <camera_aravis/StreamStatistics.h>
 
 #include <camera_aravis/get_integer_feature_value.h>
 #include <camera_aravis/set_integer_feature_value.h>
@@ -74,11 +80,28 @@ extern "C" {
 
 #include <camera_aravis/execute_command.h>
 
+#include <camera_aravis/get_features.h>
+#include <camera_aravis/set_features.h>
+
+#include <camera_aravis/write_trace.h>
+
 #include <camera_aravis/camera_buffer_pool.h>
 #include <camera_aravis/conversion_utils.h>
 
 
 #include <camera_aravis_internal/GPtr.h>
+#include <camera_aravis_internal/bandwidth_scheduler.h>
+#include <camera_aravis_internal/clock_estimator.h>
+#include <camera_aravis_internal/control_executor.h>
+#include <camera_aravis_internal/feature_value_cache.h>
+#include <camera_aravis_internal/frame_set_assembler.h>
+#include <camera_aravis_internal/gv_stream_tuner.h>
+#include <camera_aravis_internal/latency_histogram.h>
+#include <camera_aravis_internal/parallel_compressor.h>
+#include <camera_aravis_internal/serialized_image_publisher.h>
+#include <camera_aravis_internal/shm_image_ring.h>
+#include <camera_aravis_internal/stream_monitor.h>
+#include <camera_aravis_internal/tuneUVStream.h>
 
 namespace camera_aravis {
 
@@ -93,6 +116,35 @@ namespace camera_aravis {
         std::string guid_ = "";
         std::string frame_id_ = "";
         bool use_ptp_stamp_ = false;
+        bool fuse_timestamps_ = false;   // map the camera clock onto the host clock
+        bool latch_timestamps_ = false;  // ... calibrated by latching the camera clock
+        double timestamp_latch_period_ = 1.0;
+        bool publish_frame_timing_ = false;
+        double stream_statistics_rate_ = 1.0;
+        std::string trace_file_ = "";
+        gint packet_size_ = 0;  // GigE Vision, 0 to negotiate
+        int n_stream_buffers_ = 10;  // queued buffers, i.e. frames in flight
+        bool shm_transport_ = false;  // also publish the images through shared memory
+        bool preserialized_publishing_ = false;  // serialize once for all remote subscribers
+        int n_shm_slots_ = 8;
+        mode_t shm_mode_ = 0600;  // permissions of the shared memory, readers need read and write access
+        std::string compression_format_ = "";  // in-driver compressed output, "jpeg" or "png"
+        internal::ParallelCompressor::Config compression_config_;
+        bool raw12_compression_ = false;  // lossless output of packed 12 bit images
+        int preview_binning_ = 0;         // downscale factor of the preview output, 0 without
+        double preview_rate_ = 5.0;       // Hz, 0 for every frame
+        internal::UvStreamOptions uv_stream_options_;
+        bool gv_packet_socket_ = true;
+        // GigE Vision multicast destination of the streams (stream i on port + i), empty for unicast. The nodelet then
+        // only controls the camera and publishes no images, CameraAravisListenerNodelet receives them.
+        std::string multicast_address_ = "";
+        int multicast_port_ = 50000;
+        internal::GvStreamOptions gv_stream_options_;
+        bool gv_stream_tuning_ = false;
+        internal::GvStreamTuner::Bounds gv_tuning_bounds_;
+        bool bandwidth_scheduling_ = false;
+        double bandwidth_link_speed_ = 0.0;  // bit/s of the link shared by the cameras, 0 for the camera link speed
+        double bandwidth_utilization_ = 0.9;
 
         GPtr<ArvCamera> camera = nullptr;
         NonOwnedGPtr<ArvDevice> device = nullptr;
@@ -113,8 +165,19 @@ namespace camera_aravis {
             size_t n_bits_pixel = 0;
         };
 
+        struct Stream;
+
+        // A frame held back until its frame set is complete
+        struct FrameSetMember {
+            Stream* stream = nullptr;  // also has the frame id, which is not copied for every frame
+            sensor_msgs::ImagePtr image;  // null if the stream has no subscribers
+            sensor_msgs::CameraInfoPtr camera_info;
+        };
+        using FrameSetAssembler = internal::FrameSetAssembler<FrameSetMember>;
+
         struct Stream {
             std::string name;
+            std::string frame_id;  // of the camera, with the stream name appended if it has one
             GPtr<ArvStream> arv_stream;
             Sensor sensor_description;
             CameraBufferPool::Ptr buffer_pool;
@@ -122,7 +185,36 @@ namespace camera_aravis {
             ros::NodeHandle camera_info_node_handle;
             sensor_msgs::CameraInfoPtr camera_info;
             image_transport::CameraPublisher camera_publisher;
+            // while the raw image only has remote subscribers, used instead of camera_publisher
+            std::unique_ptr<internal::SerializedImagePublisher> serialized_publisher;
+            ros::Publisher camera_info_publisher;
             ConversionFunction conversion_function;
+            std::unique_ptr<internal::FrameLatency> latency = std::make_unique<internal::FrameLatency>();
+            ros::Publisher frame_timing_publisher;
+            std::unique_ptr<internal::StreamMonitor> monitor = std::make_unique<internal::StreamMonitor>();
+            ros::Publisher statistics_publisher;
+            StreamStatistics last_statistics;  // guarded by stream_statistics_mutex_
+            internal::GvStreamOptions gv_options;  // in use, GigE Vision only
+            std::unique_ptr<internal::GvStreamTuner> gv_tuner;
+            std::shared_ptr<internal::ClockEstimator> clock;  // if timestamps are fused
+            bool clock_from_frames = true;                    // otherwise it is calibrated by latching
+            std::shared_ptr<FrameSetAssembler> frame_sets;    // if frames are published in sets
+            size_t frame_set_source = 0;
+            ros::Publisher frame_set_publisher;
+            ros::Publisher shm_publisher;                    // descriptors of the images in shm_ring
+            std::unique_ptr<internal::ShmImageRing> shm_ring;  // created on demand, sized by the images
+            std::string shm_name;
+            uint32_t n_shm_slots = 0;
+            mode_t shm_mode = 0600;
+            ros::Publisher compressed_publisher;  // replaces the compressed plugin of image_transport
+            std::unique_ptr<internal::ParallelCompressor> compressor;
+            ros::Publisher raw12_publisher;  // packed 12 bit images, compressed before the conversion
+            std::unique_ptr<internal::ParallelCompressor> raw12_compressor;
+            image_transport::CameraPublisher preview_publisher;  // binned images at a reduced rate
+            uint32_t preview_binning = 0;
+            uint64_t preview_interval_ns = 0;
+            uint64_t last_preview_ns = 0;
+            std::unique_ptr<internal::LatencyHistogram> preview_time;
         };
 
         void print_capabilities();
@@ -130,13 +222,31 @@ namespace camera_aravis {
         // Start and stop camera on demand
         void rosConnectCallback();
 
+        // Whether anybody listens to the images of the stream, on any of its outputs
+        static bool isSubscribed(const Stream& stream);
+
         // Callback to wrap and send recorded image as ROS message
         static void newBufferReady(Stream& stream,
-                                   std::string frame_id,
+                                   const std::string& frame_id,
                                    int32_t width,
                                    int32_t height,
                                    bool use_ptp_stamp);
 
+        // Publish an image and its CameraInfo on all transports of the stream
+        static void publishImage(Stream& stream, const sensor_msgs::ImagePtr& image,
+                                 const sensor_msgs::CameraInfoPtr& camera_info);
+
+        // Publish a binned copy of the image, at most at the preview rate
+        static void publishPreview(Stream& stream, const sensor_msgs::Image& image,
+                                   const sensor_msgs::CameraInfo& camera_info);
+
+        // Publish the members of a completed frame set, called by the assembler
+        static void publishFrameSet(uint64_t set_id, std::vector<FrameSetAssembler::Member>& members);
+
+        // Assembler of a frame_set_group, shared by the nodelets of the process
+        static std::shared_ptr<FrameSetAssembler> sharedFrameSetAssembler(const std::string& group,
+                                                                          const FrameSetAssembler::Config& config);
+
         // Clean-up if aravis device is lost
         static void controlLostCallback(ArvDevice* p_gv_device, gpointer can_instance);
 
@@ -177,6 +287,40 @@ namespace camera_aravis {
         bool executeCommandCallback(camera_aravis::execute_command::Request& request,
                                     camera_aravis::execute_command::Response& response);
 
+        // Batched access, the device is locked once per batch
+        ros::ServiceServer get_features_service_;
+        bool getFeaturesCallback(camera_aravis::get_features::Request& request,
+                                 camera_aravis::get_features::Response& response);
+
+        ros::ServiceServer set_features_service_;
+        bool setFeaturesCallback(camera_aravis::set_features::Request& request,
+                                 camera_aravis::set_features::Response& response);
+
+        ros::ServiceServer write_trace_service_;
+        bool writeTraceCallback(camera_aravis::write_trace::Request& request,
+                                camera_aravis::write_trace::Response& response);
+
+        // Feature watch, polls features centrally and publishes their changes
+        struct WatchedFeature {
+            ArvGcNode* node = nullptr;  // resolved once, owned by the device
+            FeatureValue value;         // last published value
+            bool valid = false;
+        };
+
+        struct FeatureWatch {
+            ros::Timer timer;
+            std::vector<WatchedFeature> features;
+            uint32_t generation = 0;
+        };
+
+        std::vector<FeatureWatch> feature_watches_;
+        ros::Publisher feature_changes_publisher_;
+        // incremented for every new subscriber, each watch publishes its full state once per generation
+        std::atomic<uint32_t> feature_watch_generation_{1};
+
+        void setupFeatureWatch(ros::NodeHandle& pnh);
+        void pollFeatureWatch(FeatureWatch& watch);
+
         void shutdown();
 
         static void parseStringArgs(const std::string& in_arg_string, std::vector<std::string>& out_args);
@@ -198,8 +342,61 @@ namespace camera_aravis {
 
         ros::Timer software_trigger_timer_;
 
+        // Windowed stream metrics, published and added to the diagnostics
+        ros::Timer stream_statistics_timer_;
+        std::mutex stream_statistics_mutex_;
+        void updateStreamStatistics();
+
+        // Calibrate latched_clock_ by latching the camera timestamp, off the frame path
+        void latchTimestamp();
+        std::shared_ptr<internal::ClockEstimator> latched_clock_;
+        std::string latch_command_;
+        std::string latch_value_;
+        gint64 latch_tick_frequency_ = 1000000000;
+        ros::Timer timestamp_latch_timer_;
+        std::atomic<bool> latch_pending_{false};
+        std::atomic<uint64_t> latch_round_trip_ns_{0};
+
+        // Streams matched into frame sets (with the cameras of frame_set_group_ if set), null if disabled
+        std::shared_ptr<FrameSetAssembler> frame_sets_;
+        std::string frame_set_group_;
+        ros::Publisher frame_set_publisher_;
+        ros::WallTimer frame_set_timer_;  // expires frames waiting for a set
+
+        // Execute a command through the feature cache (once it exists), which drops the values the command may change
+        void executeCommand(const char* cmd);
+
+        // Select the GigE Vision stream channel addressed by the GevSC* features, on the control thread
+        void selectStreamChannel(int stream_id);
+
+        // Send a GigE Vision stream to multicast_address_ instead of this host
+        void setMulticastDestination(int stream_id);
+
+        // Pace a GigE Vision stream to its share of the link shared with the other cameras of the process
+        void scheduleBandwidth(int stream_id, gint packet_size, gint64 n_bytes_payload);
+        std::vector<uint64_t> bandwidth_members_;
+
         std::unordered_map<std::string, const bool> implemented_features_;
 
+        // Whether the camera has the feature and it is usable now, not only listed in its GenICam description
+        bool isImplemented(const std::string& feature) const;
+
+        // Feature values as seen by diagnostics and services, served locally wherever GenICam allows it
+        std::unique_ptr<aravis::device::feature::ValueCache> feature_cache_;
+
+        // Serializes all control channel transactions once the camera is set up
+        std::unique_ptr<internal::ControlExecutor> control_executor_;
+
+        // Run a control channel transaction through the executor (or in place, as long as there is none)
+        template<typename F>
+        auto control(internal::ControlExecutor::Priority priority, F&& fn) -> decltype(fn()) {
+            if (!control_executor_) { return fn(); }
+            return control_executor_->run(priority, std::forward<F>(fn));
+        }
+
+        std::atomic<bool> ptp_check_pending_{false};
+        std::atomic<bool> control_lost_{false};
+
         struct {
             int32_t x = 0;
             int32_t y = 0;
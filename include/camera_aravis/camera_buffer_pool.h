@@ -36,12 +36,17 @@ extern "C" {
 
 #include <sensor_msgs/Image.h>
 
+#include <memory>
 #include <mutex>
-#include <map>
-#include <stack>
+#include <unordered_map>
+#include <vector>
 
 namespace camera_aravis {
 
+    namespace internal {
+        class ControlBlockArena;
+    }
+
     class CameraBufferPool : public boost::enable_shared_from_this<CameraBufferPool> {
         public:
         typedef boost::shared_ptr<CameraBufferPool> Ptr;
@@ -50,7 +55,8 @@ namespace camera_aravis {
         // Note: If the CameraBufferPool is destroyed, buffers will be deallocated. Therefor, make sure
         // that the CameraBufferPool stays alive longer than the given stream object.
         //
-        // stream: 			weakly managed pointer to the stream. Used to register all allocated buffers
+        // stream: 			weakly managed pointer to the stream. Used to register all allocated buffers,
+        //				NULL for a pool of recyclable images only
         // payload_size_bytes:	size of a single buffer
         // n_preallocated_buffers:	number of initially allocated and registered buffers
         CameraBufferPool(ArvStream* stream, size_t payload_size_bytes, size_t n_preallocated_buffers = 2);
@@ -73,7 +79,7 @@ namespace camera_aravis {
 
         inline size_t getUsedSize() const {
             std::lock_guard<std::mutex> lock(mutex_);
-            return used_buffers_.size();
+            return n_used_;
         }
 
         inline size_t getPayloadSize() const { return payload_size_bytes_; }
@@ -83,22 +89,38 @@ namespace camera_aravis {
         void allocateBuffers(size_t n = 1);
 
         protected:
+        // An aravis buffer and the image message wrapping its memory
+        struct Slot {
+            sensor_msgs::Image* image = nullptr;
+            ArvBuffer* buffer = nullptr;
+            bool in_use = false;
+        };
+
+        // Hand out an image, whose deleter returns it to the pool. Once the pool is warmed up, this does not allocate:
+        // the control blocks of the shared pointers are recycled by arena_.
+        sensor_msgs::ImagePtr wrap(Slot* slot, sensor_msgs::Image* p_img);
+
         // Custom deleter for aravis buffer wrapping image messages, which
         // either pushes the buffer back to the aravis stream cleans it up
-        // when the CameraBufferPool is gone.
-        static void reclaim(const WPtr& self, sensor_msgs::Image* p_img);
+        // when the CameraBufferPool is gone. slot is nullptr for recyclable images.
+        static void reclaim(const WPtr& self, Slot* slot, sensor_msgs::Image* p_img);
 
         // Push the buffer inside the given image back to the aravis stream,
-        // remember the corresponding image message.
-        void push(sensor_msgs::Image* p_img);
+        // or keep a recyclable image for getRecyclableImg().
+        void push(Slot* slot, sensor_msgs::Image* p_img);
 
         ArvStream* stream_ = NULL;
         size_t payload_size_bytes_ = 0;
         size_t n_buffers_ = 0;
-
-        std::map<const uint8_t*, sensor_msgs::ImagePtr> available_img_buffers_;
-        std::map<sensor_msgs::Image*, ArvBuffer*> used_buffers_;
-        std::stack<sensor_msgs::ImagePtr> dangling_imgs_;
+        size_t n_used_ = 0;
+
+        // only changed by allocateBuffers(), the frame path just looks up and flags the slots
+        std::vector<std::unique_ptr<Slot>> slots_;
+        std::unordered_map<const uint8_t*, Slot*> slots_by_data_;
+        // recyclable images not in use, with room for all of them
+        std::vector<sensor_msgs::Image*> dangling_imgs_;
+        size_t n_recyclable_imgs_ = 0;
+        std::shared_ptr<internal::ControlBlockArena> arena_;
         mutable std::mutex mutex_;
         Ptr self_;
     };
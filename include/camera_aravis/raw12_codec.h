@@ -0,0 +1,61 @@
+/****************************************************************************
+ *
+ * camera_aravis
+ *
+ * Copyright © 2022 Fraunhofer IOSB and contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+
+
+#ifndef CAMERA_ARAVIS_RAW12_CODEC
+#define CAMERA_ARAVIS_RAW12_CODEC
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+
+namespace camera_aravis {
+
+    // Lossless codec of 12 bit mono and Bayer images, published by CameraAravisNodelet on image_raw/raw12
+    // (raw12_compression).
+    //
+    // The encoder reads the packed wire formats (Mono12p, BayerXX12p and the GigE Vision 1.x Mono12Packed,
+    // BayerXX12Packed) as they arrive. Each sample is predicted from its neighbors of the same color in the color
+    // filter array with the median edge detector of LOCO-I; the residuals are Rice coded with parameters adapted per
+    // color and local gradient. The rate follows the sensor noise, at least 1 bit per pixel and slightly
+    // above the packed size for pure noise.
+    //
+    // The decoder restores the image the driver publishes on image_raw, bit for bit: mono16 or bayer_xxxx16 with
+    // the 12 bits in the most significant bits of each sample.
+
+    // Whether encodeRaw12() takes images of this pixel format
+    bool isRaw12Format(const std::string& pixel_format);
+
+    // Compress an image of packed 12 bit samples, image.encoding is its pixel format. The width must be even.
+    bool encodeRaw12(const sensor_msgs::Image& image, std::vector<uint8_t>& data, std::string& error);
+
+    // Restore an image compressed by encodeRaw12(), the header is taken from the message
+    bool decodeRaw12(const sensor_msgs::CompressedImage& compressed, sensor_msgs::Image& image, std::string& error);
+
+}  // end namespace camera_aravis
+
+#endif
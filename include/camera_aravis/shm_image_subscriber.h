@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * camera_aravis
+ *
+ * Copyright © 2022 Fraunhofer IOSB and contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+
+#ifndef CAMERA_ARAVIS_SHM_IMAGE_SUBSCRIBER
+#define CAMERA_ARAVIS_SHM_IMAGE_SUBSCRIBER
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <ros/ros.h>
+
+#include <camera_aravis/ShmImage.h>
+
+namespace camera_aravis {
+
+    namespace internal {
+        class ShmImageRing;
+    }
+
+    // Subscriber of the images which a CameraAravisNodelet publishes through shared memory (shm_transport).
+    //
+    // Only the descriptors travel over ROS. The image data is read in place from the read-only mapped ring of the
+    // camera, it is valid during the callback only. Images which the camera overwrote before the callback ran (the
+    // ring was full and not held) are skipped and counted as missed.
+    class ShmImageSubscriber {
+        public:
+        using Callback = std::function<void(const ShmImageConstPtr& image, const uint8_t* data, size_t size)>;
+
+        ShmImageSubscriber(ros::NodeHandle& nh, const std::string& topic, uint32_t queue_size, Callback callback);
+        ~ShmImageSubscriber();
+
+        uint64_t getNumReceived() const { return n_received_; }
+        uint64_t getNumMissed() const { return n_missed_; }
+
+        private:
+        void imageCallback(const ShmImageConstPtr& image);
+
+        Callback callback_;
+        ros::Subscriber subscriber_;
+        std::unique_ptr<internal::ShmImageRing> ring_;
+        uint64_t n_received_ = 0;
+        uint64_t n_missed_ = 0;
+    };
+
+}  // end namespace camera_aravis
+
+#endif
@@ -3,8 +3,11 @@
 #ifndef CAMERA_ARAVIS_INTERNAL_ARAVIS_ABSTRACTION_H
 #define CAMERA_ARAVIS_INTERNAL_ARAVIS_ABSTRACTION_H
 
+#include <camera_aravis_internal/GErrorGuard.h>
 #include <camera_aravis_internal/GPtr.h>
 
+#include <string>
+
 extern "C" {
 #include <arv.h>
 }
@@ -24,6 +27,92 @@ namespace camera_aravis {
             void execute_command(const NonOwnedGPtr<ArvDevice>& dev, const char* cmd);
 
             namespace feature {
+                // Resolve the GenICam node of a feature (one lookup in the node table of the GenICam tree). Returns
+                // nullptr if the device has no such feature.
+                ArvGcNode* get_node(const NonOwnedGPtr<ArvDevice>& dev, const char* feat);
+
+                // Typed accessors which hold an already resolved node. Code accessing the same features repeatedly
+                // keeps its accessors (or nodes) instead of resolving the name again. The overloads taking a
+                // GuardedGError leave the error handling to the caller, all others log errors.
+                //
+                // Note: The node is owned by the device, so an accessor must not outlive the device it was
+                // created from.
+                class Node {
+                    public:
+                    Node() = default;
+                    Node(const NonOwnedGPtr<ArvDevice>& dev, const char* feat);
+                    // from a node resolved before, feat names the feature in errors if node is nullptr
+                    Node(ArvGcNode* node, const char* feat);
+
+                    const char* name() const { return name_; }
+
+                    ArvGcNode* node() const { return node_; }
+
+                    explicit operator bool() const { return nullptr != node_; }
+
+                    protected:
+                    bool check(bool type_matches, const char* type_name, GuardedGError& err) const;
+
+                    ArvGcNode* node_ = nullptr;
+                    const char* name_ = "";
+                };
+
+                class Boolean : public Node {
+                    public:
+                    using Node::Node;
+
+                    gboolean get() const;
+                    gboolean get(GuardedGError& err) const;
+
+                    void set(gboolean val) const;
+                    void set(gboolean val, GuardedGError& err) const;
+                };
+
+                class Integer : public Node {
+                    public:
+                    using Node::Node;
+
+                    gint64 get() const;
+                    gint64 get(GuardedGError& err) const;
+
+                    void set(gint64 val) const;
+                    void set(gint64 val, GuardedGError& err) const;
+
+                    void get_bounds(gint64* min, gint64* max) const;
+                };
+
+                class Float : public Node {
+                    public:
+                    using Node::Node;
+
+                    double get() const;
+                    double get(GuardedGError& err) const;
+
+                    void set(double val) const;
+                    void set(double val, GuardedGError& err) const;
+
+                    void get_bounds(double* min, double* max) const;
+                };
+
+                class String : public Node {
+                    public:
+                    using Node::Node;
+
+                    const char* get() const;
+                    const char* get(GuardedGError& err) const;
+
+                    void set(const char* val) const;
+                    void set(const char* val, GuardedGError& err) const;
+                };
+
+                class Command : public Node {
+                    public:
+                    using Node::Node;
+
+                    void execute() const;
+                    void execute(GuardedGError& err) const;
+                };
+
                 gboolean get_boolean(const NonOwnedGPtr<ArvDevice>& dev, const char* feat);
 
                 void set_boolean(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, gboolean val);
@@ -58,6 +147,14 @@ namespace camera_aravis {
 #endif
             }  // namespace USB3Vision
 
+            namespace GigEVision {
+                // Address of the host interface the device is reached through, empty if unknown
+                std::string get_interface_address(const NonOwnedGPtr<ArvDevice>& dev);
+
+                // Options of the streams created afterwards
+                void set_stream_options(const NonOwnedGPtr<ArvDevice>& dev, ArvGvStreamOption options);
+            }  // namespace GigEVision
+
         }  // namespace device
 
         GPtr<ArvCamera> camera_new(const char* name = NULL);
@@ -121,6 +218,15 @@ namespace camera_aravis {
 
             namespace gv {
                 void select_stream_channel(const NonOwnedGPtr<ArvCamera>& cam, gint channel_id);
+
+                // Packet size of the selected stream channel, in bytes including the IP, UDP and GVSP headers
+                gint get_packet_size(const NonOwnedGPtr<ArvCamera>& cam);
+
+                void set_packet_size(const NonOwnedGPtr<ArvCamera>& cam, gint packet_size);
+
+                // Probe for the largest packet size which reaches the host unfragmented, and apply it. Returns the
+                // packet size in use afterwards.
+                guint auto_packet_size(const NonOwnedGPtr<ArvCamera>& cam);
             }  // namespace gv
         }      // namespace camera
 
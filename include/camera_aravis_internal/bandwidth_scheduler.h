@@ -0,0 +1,64 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_BANDWIDTH_SCHEDULER_H
+#define CAMERA_ARAVIS_INTERNAL_BANDWIDTH_SCHEDULER_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace camera_aravis::internal {
+
+    // Process-wide allocation of link bandwidth to GigEVision streams.
+    //
+    // Streams reached through the same host interface form a group sharing one link. Each stream gets a share of
+    // the link budget proportional to the bandwidth it needs (equal shares if a frame rate is unknown), and is paced
+    // to that share by an inter-packet delay (GevSCPD). The first packets of the streams are staggered by one packet
+    // slot each via the frame transmission delay (GevSCFTD), so that streams triggered at the same time interleave
+    // instead of bursting together. Whenever a stream joins or leaves, the group is scheduled again.
+    class BandwidthScheduler {
+        public:
+        struct Allocation {
+            double required_bps = 0.0;   // on the wire, including Ethernet framing
+            double allocated_bps = 0.0;
+            double budget_bps = 0.0;     // of the whole group
+            double packet_delay_s = 0.0;
+            double frame_delay_s = 0.0;
+            uint64_t packet_delay_ticks = 0;
+            uint64_t frame_delay_ticks = 0;
+        };
+
+        struct Member {
+            std::string group;             // host interface address
+            double link_speed_bps = 0.0;   // of the camera, 0 if unknown
+            double shared_link_bps = 0.0;  // of the shared link if known, otherwise the camera link is assumed
+            double utilization = 0.9;      // share of the link to be used
+            uint32_t packet_size = 0;      // GevSCPSPacketSize
+            uint64_t packets_per_frame = 0;
+            double frame_rate = 0.0;       // 0 if unknown (e.g. triggered)
+            uint64_t tick_frequency = 1000000000;  // unit of the delays
+            // Called with the scheduler locked, must not block or call back into the scheduler
+            std::function<void(const Allocation&)> apply;
+        };
+
+        static BandwidthScheduler& instance();
+
+        // Returns an id for remove()
+        uint64_t add(const Member& member);
+        void remove(uint64_t id);
+
+        private:
+        BandwidthScheduler() = default;
+
+        void schedule(const std::string& group);
+
+        std::mutex mutex_;
+        uint64_t next_id_ = 1;
+        std::map<uint64_t, Member> members_;  // ordered by joining
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
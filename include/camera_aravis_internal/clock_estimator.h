@@ -0,0 +1,86 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_CLOCK_ESTIMATOR_H
+#define CAMERA_ARAVIS_INTERNAL_CLOCK_ESTIMATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace camera_aravis::internal {
+
+    // Online estimate of the mapping from the camera clock to the host clock.
+    //
+    // Fed with the camera timestamp and the host arrival time of each frame, it fits host = offset + rate * camera
+    // over a sliding window: least squares, then again without outliers (median/MAD), and finally shifted to the
+    // lower envelope of the residuals, since transfer and scheduling delays only ever add to the arrival time. The
+    // mapped stamps keep the stable spacing of the camera clock and the time base of the host clock. A camera clock
+    // running backwards or deviating by more than a second starts the estimate anew.
+    //
+    // The same fit serves for exact samples, like latched camera timestamps bracketed by host clock readings: fitted
+    // to the median instead of the lower envelope and refitted with every sample, mapping frames with map().
+    //
+    // update() and map() do not allocate, all methods may be called from any thread.
+    class ClockEstimator {
+        public:
+        struct Statistics {
+            bool valid = false;
+            uint64_t n_samples = 0;          // within the window
+            uint64_t n_resets = 0;
+            double offset_s = 0.0;           // host minus camera time, at the latest sample
+            double drift_ppm = 0.0;          // rate of the host clock relative to the camera clock
+            double residual_stddev_s = 0.0;  // of the arrival times around the fit, i.e. their jitter
+            double residual_max_s = 0.0;
+        };
+
+        explicit ClockEstimator(size_t window = 512, double envelope_quantile = 0.05, size_t refit_interval = 8);
+
+        // Add a sample. Returns the host time (ns) the camera timestamp maps to.
+        uint64_t update(uint64_t camera_ns, uint64_t host_ns);
+
+        // Host time (ns) a camera timestamp maps to, 0 before the first sample.
+        uint64_t map(uint64_t camera_ns) const;
+
+        Statistics get_statistics() const;
+
+        private:
+        struct Sample {
+            double x;  // camera time since the reference (s)
+            double y;  // host time since the reference (s)
+        };
+
+        static constexpr double MIN_SPAN_S = 1.0;       // for a rate estimate
+        static constexpr double MAX_DRIFT = 1e-3;
+        static constexpr double MAX_DEVIATION_S = 1.0;  // before starting anew
+
+        void reset(uint64_t camera_ns, uint64_t host_ns);
+        void fit();
+        double predict(double x) const { return intercept_ + rate_ * x; }
+
+        const double envelope_quantile_;
+        const size_t refit_interval_;
+
+        mutable std::mutex mutex_;
+        std::vector<Sample> samples_;  // ring buffer
+        std::vector<double> scratch_;
+        std::vector<char> inlier_;
+        size_t head_ = 0;
+        size_t n_samples_ = 0;
+        size_t n_since_fit_ = 0;
+
+        bool initialized_ = false;
+        uint64_t camera_ref_ns_ = 0;
+        uint64_t host_ref_ns_ = 0;
+        double last_x_ = 0.0;
+
+        double rate_ = 1.0;
+        double intercept_ = 0.0;
+        double residual_stddev_s_ = 0.0;
+        double residual_max_s_ = 0.0;
+        uint64_t n_resets_ = 0;
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
@@ -0,0 +1,110 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_CONTROL_EXECUTOR_H
+#define CAMERA_ARAVIS_INTERNAL_CONTROL_EXECUTOR_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace camera_aravis::internal {
+
+    // Runs all control channel transactions of a device on a single thread.
+    //
+    // Pending requests are served by priority (and in order of submission within a priority), so that triggers
+    // and acquisition control only ever wait for the transaction currently on the wire, but not for queued
+    // diagnostics or service traffic.
+    class ControlExecutor {
+        public:
+        enum Priority { TRIGGER = 0, ACQUISITION, SERVICE, DIAGNOSTICS, N_PRIORITIES };
+
+        struct Statistics {
+            uint64_t n_requests = 0;  // total number of executed requests
+            size_t n_pending = 0;
+            // queue latency of the requests executed since the previous call of get_statistics()
+            uint64_t n_window = 0;
+            double mean_latency_ms = 0.0;
+            double max_latency_ms = 0.0;
+        };
+
+        ControlExecutor();
+        ~ControlExecutor();
+
+        ControlExecutor(const ControlExecutor&) = delete;
+        ControlExecutor& operator=(const ControlExecutor&) = delete;
+
+        // Queue a request without waiting for it.
+        void post(Priority priority, std::function<void()> fn);
+
+        // Queue a request and wait for its result. Requests issued from the executor thread itself, or after the
+        // executor was stopped, are run in place.
+        template<typename F>
+        auto run(Priority priority, F&& fn) -> decltype(fn()) {
+            using R = decltype(fn());
+            if (!is_running() || std::this_thread::get_id() == worker_.get_id()) { return fn(); }
+
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+            std::future<R> result = task->get_future();
+            post(priority, [task]() { (*task)(); });
+            try {
+                return result.get();
+            } catch (const std::future_error&) {
+                // dropped by stop()
+                return R();
+            }
+        }
+
+        // Stop the executor thread, pending requests are dropped.
+        void stop();
+
+        bool is_running() const;
+
+        // Statistics of a request class. Resets the latency window of this class.
+        Statistics get_statistics(Priority priority);
+
+        static const char* priority_name(Priority priority);
+
+        private:
+        struct Request {
+            Priority priority;
+            uint64_t sequence;
+            std::chrono::steady_clock::time_point enqueued;
+            std::function<void()> fn;
+        };
+
+        struct RequestOrder {
+            bool operator()(const Request& lhs, const Request& rhs) const {
+                if (lhs.priority != rhs.priority) return lhs.priority > rhs.priority;
+                return lhs.sequence > rhs.sequence;
+            }
+        };
+
+        struct ClassStatistics {
+            uint64_t n_requests = 0;
+            size_t n_pending = 0;
+            uint64_t n_window = 0;
+            double sum_latency_ms = 0.0;
+            double max_latency_ms = 0.0;
+        };
+
+        void spin();
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::priority_queue<Request, std::vector<Request>, RequestOrder> queue_;
+        std::array<ClassStatistics, N_PRIORITIES> statistics_;
+        uint64_t sequence_ = 0;
+        bool running_ = true;
+        std::thread worker_;
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
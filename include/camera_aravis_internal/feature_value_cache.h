@@ -0,0 +1,136 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_FEATURE_VALUE_CACHE_H
+#define CAMERA_ARAVIS_INTERNAL_FEATURE_VALUE_CACHE_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <camera_aravis_internal/aravis_abstraction.h>
+
+namespace camera_aravis::aravis::device::feature {
+
+    // Client side cache of feature values.
+    //
+    // Whether a value may be served locally is derived from the GenICam caching metadata of the feature and of all
+    // nodes its value depends on: a value is read from the device every time if any register involved is marked
+    // <Cachable>NoCache</Cachable> or has a <PollingTime>. Cached values are dropped when the feature itself, one
+    // of its invalidators (pInvalidator), its lock (pIsLocked) or any other feature its value, limits or
+    // availability depend on is successfully written through this cache. Commands drop the whole cache, since
+    // their effect is not described by the GenICam tree.
+    //
+    // Writes which bypass the cache (e.g. through aravis::camera) must be followed by invalidate() of the written
+    // feature.
+    //
+    // Most cameras leave their registers at the default WriteThrough caching, also for values the camera changes by
+    // itself (auto exposure, temperatures, frame rate limits). get_* is meant for the driver's own configuration
+    // reads; values reported to users are read with read_*, which always asks the device.
+    class ValueCache {
+        public:
+        struct Statistics {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t uncachable = 0;
+            uint64_t invalidations = 0;
+
+            double hit_rate() const;
+        };
+
+        explicit ValueCache(const NonOwnedGPtr<ArvDevice>& dev);
+
+        gboolean get_boolean(const char* feat);
+        gboolean get_boolean(const char* feat, GuardedGError& err);
+
+        gint64 get_integer(const char* feat);
+        gint64 get_integer(const char* feat, GuardedGError& err);
+
+        double get_float(const char* feat);
+        double get_float(const char* feat, GuardedGError& err);
+
+        std::string get_string(const char* feat);
+        std::string get_string(const char* feat, GuardedGError& err);
+
+        // Read from the device, bypassing the cached value, and cache the result for get_*.
+        gboolean read_boolean(const char* feat);
+        gboolean read_boolean(const char* feat, GuardedGError& err);
+
+        gint64 read_integer(const char* feat);
+        gint64 read_integer(const char* feat, GuardedGError& err);
+
+        double read_float(const char* feat);
+        double read_float(const char* feat, GuardedGError& err);
+
+        std::string read_string(const char* feat);
+        std::string read_string(const char* feat, GuardedGError& err);
+
+        void set_boolean(const char* feat, gboolean val);
+        void set_boolean(const char* feat, gboolean val, GuardedGError& err);
+
+        void set_integer(const char* feat, gint64 val);
+        void set_integer(const char* feat, gint64 val, GuardedGError& err);
+
+        void set_float(const char* feat, double val);
+        void set_float(const char* feat, double val, GuardedGError& err);
+
+        void set_string(const char* feat, const char* val);
+        void set_string(const char* feat, const char* val, GuardedGError& err);
+
+        void execute_command(const char* cmd);
+        void execute_command(const char* cmd, GuardedGError& err);
+
+        // Drop the cached values of the given feature and of all features depending on it.
+        void invalidate(const std::string& feat);
+
+        // Drop all cached values.
+        void clear();
+
+        Statistics get_statistics() const;
+
+        // Hold the cache (and thereby the device access through it) for a sequence of operations.
+        std::unique_lock<std::recursive_mutex> lock() const { return std::unique_lock<std::recursive_mutex>(mutex_); }
+
+        private:
+        enum ValueType : uint8_t { BOOLEAN = 1 << 0, INTEGER = 1 << 1, FLOAT = 1 << 2, STRING = 1 << 3 };
+
+        struct Policy {
+            ArvGcNode* node = nullptr;  // resolved once, owned by the device
+            bool cachable = true;
+            // all features (besides the feature itself) whose writes affect the value
+            std::unordered_set<std::string> dependencies;
+        };
+
+        struct Entry {
+            uint8_t valid = 0;
+            gboolean boolean = FALSE;
+            gint64 integer = 0;
+            double real = 0.0;
+            std::string string;
+        };
+
+        const Policy& get_policy(const char* feat);
+
+        // Look up a cached value. Returns true on a hit, otherwise the caller has to read from the device.
+        template<typename T>
+        bool lookup(const char* feat, const Policy& policy, ValueType type, T Entry::*member, T& out);
+
+        template<typename T>
+        void store(const char* feat, const Policy& policy, ValueType type, T Entry::*member, const T& val);
+
+        NonOwnedGPtr<ArvDevice> device_;
+
+        mutable std::recursive_mutex mutex_;
+        std::unordered_map<std::string, Policy> policies_;
+        std::unordered_map<std::string, Entry> entries_;
+
+        std::atomic<uint64_t> n_hits_{0};
+        std::atomic<uint64_t> n_misses_{0};
+        std::atomic<uint64_t> n_uncachable_{0};
+        std::atomic<uint64_t> n_invalidations_{0};
+    };
+
+}  // namespace camera_aravis::aravis::device::feature
+
+#endif
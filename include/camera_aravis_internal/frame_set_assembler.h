@@ -0,0 +1,221 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_FRAME_SET_ASSEMBLER_H
+#define CAMERA_ARAVIS_INTERNAL_FRAME_SET_ASSEMBLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace camera_aravis::internal {
+
+    // Matches the frames of several sources (streams of a multi-source camera, or cameras of a rig) into sets.
+    //
+    // Each source keeps its unmatched frames in a small ring. A frame completes a set once every other active source
+    // holds a frame with the same frame id, or with a timestamp within the tolerance (the closest one is taken).
+    // Frames older than those of a completed set can no longer be matched, since every source delivers in order, and
+    // are dropped, as are frames which waited longer than the timeout or were pushed out of a full ring.
+    //
+    // Frames are added from the threads of the sources, a completed set is handed to the callback of add() on the
+    // thread completing it. The callback runs unlocked, so that the other sources keep adding frames meanwhile, but
+    // sets are handed out one at a time and in order, and remove_source() waits for the sets completed before.
+    // Frames are also expired by add(), expire() does it for sources which stopped delivering.
+    template<typename Frame>
+    class FrameSetAssembler {
+        public:
+        struct Config {
+            bool match_frame_id = true;     // otherwise by timestamp
+            uint64_t tolerance_ns = 1000000;
+            uint64_t timeout_ns = 100000000;
+            size_t ring_size = 4;           // frames held per source
+        };
+
+        struct Member {
+            size_t source = 0;
+            uint64_t frame_id = 0;
+            uint64_t timestamp_ns = 0;
+            Frame frame;
+        };
+
+        // Cumulative counters of a source
+        struct Statistics {
+            uint64_t n_frames = 0;
+            uint64_t n_matched = 0;
+            uint64_t n_timed_out = 0;    // waited for the other sources longer than the timeout
+            uint64_t n_overwritten = 0;  // pushed out of the full ring
+            uint64_t n_skipped = 0;      // older than a completed set
+
+            uint64_t n_dropped() const { return n_timed_out + n_overwritten + n_skipped; }
+        };
+
+        explicit FrameSetAssembler(const Config& config): config_(config) {}
+
+        const Config& config() const { return config_; }
+
+        size_t add_source() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sources_.emplace_back();
+            sources_.back().active = true;
+            return sources_.size() - 1;
+        }
+
+        // The source is not waited for anymore, its pending frames are released. Returns once the sets completed
+        // before, which may hold frames of the source, are handed out.
+        void remove_source(size_t source) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (source >= sources_.size()) { return; }
+            sources_[source].active = false;
+            sources_[source].ring.clear();
+
+            const uint64_t n_completed = n_sets_;
+            handed_out_.wait(lock, [this, n_completed]() { return n_handed_out_ >= n_completed; });
+        }
+
+        // Drop the frames which waited longer than the timeout
+        void expire() {
+            const uint64_t now_ns = steady_time_ns();
+            std::lock_guard<std::mutex> lock(mutex_);
+            drop_expired(now_ns);
+        }
+
+        Statistics get_statistics(size_t source) const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return source < sources_.size() ? sources_[source].statistics : Statistics();
+        }
+
+        uint64_t n_sets() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return n_sets_;
+        }
+
+        // on_set(set_id, members) is called for every set completed by this frame, members ordered by source
+        template<typename Callback>
+        void add(size_t source, uint64_t frame_id, uint64_t timestamp_ns, Frame frame, Callback&& on_set) {
+            const uint64_t now_ns = steady_time_ns();
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (source >= sources_.size() || !sources_[source].active) { return; }
+
+            drop_expired(now_ns);
+
+            Source& own = sources_[source];
+            ++own.statistics.n_frames;
+            if (own.ring.size() >= config_.ring_size) {
+                own.ring.pop_front();
+                ++own.statistics.n_overwritten;
+            }
+            own.ring.push_back(Pending{now_ns, Member{source, frame_id, timestamp_ns, std::move(frame)}});
+
+            // position of the matching frame in the ring of every source
+            match_.assign(sources_.size(), 0);
+            for (size_t i = 0; i < sources_.size(); ++i) {
+                if (!sources_[i].active) { continue; }
+                if (i == source) {
+                    match_[i] = own.ring.size() - 1;
+                    continue;
+                }
+                if (!find_match(sources_[i], frame_id, timestamp_ns, match_[i])) { return; }
+            }
+
+            // only used by the thread of the source, also while unlocked
+            std::vector<Member>& members = own.completed;
+            members.clear();
+            for (size_t i = 0; i < sources_.size(); ++i) {
+                if (!sources_[i].active) { continue; }
+                Source& matched = sources_[i];
+                matched.statistics.n_skipped += match_[i];
+                ++matched.statistics.n_matched;
+                members.push_back(std::move(matched.ring[match_[i]].member));
+                matched.ring.erase(matched.ring.begin(), matched.ring.begin() + match_[i] + 1);
+            }
+
+            const uint64_t set_id = n_sets_++;
+            handed_out_.wait(lock, [this, set_id]() { return n_handed_out_ == set_id; });
+            lock.unlock();
+            {
+                // the next set is handed out also if the callback throws
+                HandOut hand_out{*this};
+                on_set(set_id, members);
+                members.clear();
+            }
+        }
+
+        private:
+        struct Pending {
+            uint64_t added_ns;
+            Member member;
+        };
+
+        struct Source {
+            bool active = false;
+            std::deque<Pending> ring;
+            Statistics statistics;
+            std::vector<Member> completed;  // the last set completed by this source, reused
+        };
+
+        struct HandOut {
+            FrameSetAssembler& self;
+
+            ~HandOut() {
+                std::lock_guard<std::mutex> lock(self.mutex_);
+                ++self.n_handed_out_;
+                self.handed_out_.notify_all();
+            }
+        };
+
+        static uint64_t steady_time_ns() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        bool find_match(const Source& other, uint64_t frame_id, uint64_t timestamp_ns, size_t& position) const {
+            bool found = false;
+            uint64_t best_distance = 0;
+            for (size_t j = 0; j < other.ring.size(); ++j) {
+                const Member& candidate = other.ring[j].member;
+                if (config_.match_frame_id) {
+                    if (candidate.frame_id != frame_id) { continue; }
+                    position = j;
+                    return true;
+                }
+
+                const uint64_t distance = candidate.timestamp_ns > timestamp_ns ? candidate.timestamp_ns - timestamp_ns
+                                                                                : timestamp_ns - candidate.timestamp_ns;
+                if (distance <= config_.tolerance_ns && (!found || distance < best_distance)) {
+                    found = true;
+                    best_distance = distance;
+                    position = j;
+                }
+            }
+            return found;
+        }
+
+        void drop_expired(uint64_t now_ns) {
+            for (Source& source : sources_) {
+                while (!source.ring.empty() && now_ns - source.ring.front().added_ns > config_.timeout_ns) {
+                    source.ring.pop_front();
+                    ++source.statistics.n_timed_out;
+                }
+            }
+        }
+
+        const Config config_;
+        mutable std::mutex mutex_;
+        std::deque<Source> sources_;  // stable references, add_source() may run while a set is handed out
+        uint64_t n_sets_ = 0;
+        uint64_t n_handed_out_ = 0;
+        std::condition_variable handed_out_;
+
+        // reused across calls, guarded by mutex_
+        std::vector<size_t> match_;
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
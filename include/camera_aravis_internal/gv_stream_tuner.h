@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_GV_STREAM_TUNER_H
+#define CAMERA_ARAVIS_INTERNAL_GV_STREAM_TUNER_H
+
+#include <camera_aravis_internal/tuneGVStream.h>
+
+#include <cstdint>
+
+namespace camera_aravis::internal {
+
+    // Closed-loop tuning of the receiver options of a GigEVision stream.
+    //
+    // Fed with the statistics of consecutive windows: On packet loss the socket buffer is grown (resends and
+    // missing packets mostly mean the socket overflowed), and packet timeout and frame retention are raised so
+    // that resends can still complete. After a number of windows without any loss, packet timeout and frame
+    // retention are lowered again, since they bound the delay of incomplete frames. Frame retention is also kept
+    // below a few frame intervals.
+    class GvStreamTuner {
+        public:
+        struct Bounds {
+            guint max_socket_buffer_size = 16 << 20;
+            guint min_packet_timeout_ms = 10;
+            guint max_packet_timeout_ms = 200;
+            guint min_frame_retention_ms = 50;
+            guint max_frame_retention_ms = 1000;
+        };
+
+        struct Observation {
+            uint64_t n_frames = 0;
+            uint64_t n_resent = 0;
+            uint64_t n_missing = 0;
+            uint64_t n_failures = 0;
+            double interval_mean_s = 0.0;
+        };
+
+        GvStreamTuner(const GvStreamOptions& options, const Bounds& bounds);
+
+        // Returns whether the options changed.
+        bool update(const Observation& observation);
+
+        const GvStreamOptions& options() const { return options_; }
+
+        private:
+        static constexpr int N_CLEAN_WINDOWS = 5;
+        static constexpr guint INITIAL_SOCKET_BUFFER_SIZE = 1 << 20;
+        static constexpr double FRAME_RETENTION_INTERVALS = 3.0;
+
+        GvStreamOptions options_;
+        Bounds bounds_;
+        int n_clean_windows_ = 0;
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_GVSP_RECEIVER_H
+#define CAMERA_ARAVIS_INTERNAL_GVSP_RECEIVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace camera_aravis::internal {
+
+    // Receiver of a GigE Vision stream (GVSP) sent to a multicast group.
+    //
+    // Aravis streams only receive on the unicast socket they configured the camera for, so read-only listeners
+    // of a multicast stream reassemble the image frames themselves. Listeners have no control channel, hence
+    // missing packets cannot be resent and incomplete frames are dropped. Handles image payloads with standard
+    // and extended ids.
+    class GvspReceiver {
+        public:
+        struct Config {
+            std::string address;            // multicast group
+            uint16_t port = 0;
+            std::string interface_address;  // local interface to join on, empty for the default
+            int socket_buffer_size = 0;     // bytes, 0 for the system default
+        };
+
+        struct Frame {
+            uint64_t block_id = 0;
+            uint64_t timestamp = 0;   // camera timestamp from the leader, in camera ticks
+            uint64_t arrival_ns = 0;  // host time of the leader
+            uint32_t pixel_format = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<uint8_t> data;
+        };
+
+        struct Statistics {
+            uint64_t n_completed = 0;
+            uint64_t n_incomplete = 0;
+            uint64_t n_packets = 0;
+            uint64_t n_ignored = 0;  // foreign, erroneous, duplicate or unsupported packets
+        };
+
+        // Called on the receiving thread. The callback may take the frame data by swapping it out, preferably for a
+        // recycled buffer of the same size: the next frame is received into whatever buffer is left in the frame.
+        using FrameCallback = std::function<void(Frame& frame)>;
+
+        GvspReceiver(const Config& config, FrameCallback callback);
+        ~GvspReceiver();
+
+        GvspReceiver(const GvspReceiver&) = delete;
+        GvspReceiver& operator=(const GvspReceiver&) = delete;
+
+        // Join the group and start receiving. Returns false and fills error on failure.
+        bool start(std::string& error);
+        void stop();
+
+        Statistics get_statistics() const;
+
+        private:
+        void receive_loop();
+        void handle_packet(const uint8_t* packet, size_t n_bytes);
+        void drop_frame();
+
+        Config config_;
+        FrameCallback callback_;
+        int fd_ = -1;
+        std::thread thread_;
+        std::atomic<bool> running_{false};
+
+        // reassembly state, receiving thread only
+        Frame frame_;
+        bool in_frame_ = false;
+        size_t n_bytes_expected_ = 0;
+        size_t n_bytes_chunk_ = 0;  // data per payload packet, all but the last are equal
+        size_t n_chunks_expected_ = 0;
+        size_t n_chunks_received_ = 0;
+        std::vector<uint64_t> packets_received_;  // bitmap by payload packet id - 1, duplicates do not count
+
+        std::atomic<uint64_t> n_completed_{0};
+        std::atomic<uint64_t> n_incomplete_{0};
+        std::atomic<uint64_t> n_packets_{0};
+        std::atomic<uint64_t> n_ignored_{0};
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
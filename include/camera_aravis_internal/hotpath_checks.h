@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_HOTPATH_CHECKS_H
+#define CAMERA_ARAVIS_INTERNAL_HOTPATH_CHECKS_H
+
+// Real-time checks of the frame path, for debug and test builds.
+//
+// Only compiled in with -DCAMERA_ARAVIS_HOTPATH_CHECKS=ON, otherwise the CA_HOTPATH_* macros reduce to plain locking
+// or nothing. When enabled, the global operator new/delete of the process are replaced by counting versions, and every
+// hot path section checks that it does not allocate from the C++ heap and that it does not wait longer than a threshold
+// for a lock. Violations are only reported once the first frames (warm-up) have passed, since buffers and images are
+// allocated lazily. They are logged and counted, or abort the process if so configured (e.g. to fail a rostest).
+//
+// Allocations through g_malloc (inside aravis) are not seen. The replaced operator new is only used process-wide if
+// this library is linked into the executable (as in a test) or preloaded; a nodelet manager loads plugins too late,
+// so run it with LD_PRELOAD=<path>/libcamera_aravis.so. configure() warns if counting is not in effect.
+//
+//   CA_HOTPATH_SCOPE("convert");                  // section spanning the enclosing scope
+//   CA_HOTPATH_BEGIN(section, "pop");             // section ended explicitly ...
+//   CA_HOTPATH_END(section);                      // ... (or at the end of the scope)
+//   CA_HOTPATH_LOCK_GUARD(lock, mutex_);          // std::lock_guard<std::mutex>, timed
+//   CA_HOTPATH_FRAME_DONE();                      // count a frame towards the warm-up
+
+#include <cstdint>
+#include <mutex>
+
+#ifdef CAMERA_ARAVIS_HOTPATH_CHECKS
+
+namespace camera_aravis::internal::hotpath {
+
+    struct Config {
+        uint64_t warmup_frames = 100;
+        uint64_t max_lock_wait_ns = 100000;
+        bool abort_on_violation = false;
+    };
+
+    struct Statistics {
+        uint64_t n_frames = 0;
+        uint64_t n_sections = 0;
+        uint64_t n_allocations = 0;  // within sections after the warm-up
+        uint64_t n_lock_waits = 0;   // contended lock acquisitions within sections
+        uint64_t max_lock_wait_ns = 0;
+        uint64_t n_violations = 0;
+    };
+
+    void configure(const Config& config);
+    Statistics get_statistics();
+
+    void frame_done();
+
+    // Number of C++ heap allocations of the calling thread so far
+    uint64_t thread_allocations();
+
+    class Section {
+        public:
+        explicit Section(const char* name);
+        ~Section() { end(); }
+
+        Section(const Section&) = delete;
+        Section& operator=(const Section&) = delete;
+
+        void end();
+
+        private:
+        const char* name_;
+        uint64_t n_allocations_begin_;
+        uint64_t n_excluded_begin_;
+        bool active_ = true;
+    };
+
+    // std::lock_guard which reports long waits for the mutex
+    class TimedLockGuard {
+        public:
+        TimedLockGuard(std::mutex& mutex, const char* name);
+        ~TimedLockGuard() { mutex_.unlock(); }
+
+        TimedLockGuard(const TimedLockGuard&) = delete;
+        TimedLockGuard& operator=(const TimedLockGuard&) = delete;
+
+        private:
+        std::mutex& mutex_;
+    };
+
+}  // namespace camera_aravis::internal::hotpath
+
+#define CA_HOTPATH_CONCAT_IMPL(a, b) a##b
+#define CA_HOTPATH_CONCAT(a, b) CA_HOTPATH_CONCAT_IMPL(a, b)
+#define CA_HOTPATH_SCOPE(name) \
+    ::camera_aravis::internal::hotpath::Section CA_HOTPATH_CONCAT(ca_hotpath_section_, __LINE__)(name)
+#define CA_HOTPATH_BEGIN(var, name) ::camera_aravis::internal::hotpath::Section var(name)
+#define CA_HOTPATH_END(var) var.end()
+#define CA_HOTPATH_LOCK_GUARD(var, mutex) ::camera_aravis::internal::hotpath::TimedLockGuard var(mutex, #mutex)
+#define CA_HOTPATH_FRAME_DONE() ::camera_aravis::internal::hotpath::frame_done()
+
+#else
+
+#define CA_HOTPATH_SCOPE(name) \
+    do {                       \
+    } while (false)
+#define CA_HOTPATH_BEGIN(var, name) \
+    do {                            \
+    } while (false)
+#define CA_HOTPATH_END(var) \
+    do {                    \
+    } while (false)
+#define CA_HOTPATH_LOCK_GUARD(var, mutex) std::lock_guard<std::mutex> var(mutex)
+#define CA_HOTPATH_FRAME_DONE() \
+    do {                        \
+    } while (false)
+
+#endif
+
+#endif
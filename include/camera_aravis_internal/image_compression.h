@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_IMAGE_COMPRESSION_H
+#define CAMERA_ARAVIS_INTERNAL_IMAGE_COMPRESSION_H
+
+#include <string>
+
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+
+namespace camera_aravis::internal {
+
+    // JPEG (libjpeg-turbo) and PNG (libpng) encoding of images.
+    //
+    // The format field of the result follows compressed_image_transport ("rgb8; jpeg compressed bgr8"), so that its
+    // subscribers decode the images. JPEG takes 8 bit mono and color images, PNG also 16 bit mono and Bayer images.
+    // RAW12 takes packed 12 bit images as they arrive from the camera (see camera_aravis/raw12_codec.h), with the pixel
+    // format as encoding.
+    struct CompressionOptions {
+        enum Format { JPEG, PNG, RAW12 };
+
+        Format format = JPEG;
+        int jpeg_quality = 90;  // 1 to 100
+        int png_level = 3;      // zlib level, 0 to 9
+    };
+
+    // Returns false and fills error if the image cannot be compressed (e.g. its encoding is not supported)
+    bool compressImage(const sensor_msgs::Image& image, const CompressionOptions& options,
+                       sensor_msgs::CompressedImage& compressed, std::string& error);
+
+}  // namespace camera_aravis::internal
+
+#endif
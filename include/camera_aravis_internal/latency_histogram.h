@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_LATENCY_HISTOGRAM_H
+#define CAMERA_ARAVIS_INTERNAL_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace camera_aravis::internal {
+
+    // Lock-free histogram of durations in nanoseconds with log-linear buckets (as in HdrHistogram).
+    //
+    // Every power of two is split into 2^SUB_BUCKET_BITS linear sub-buckets, which bounds the relative error of
+    // reported quantiles to 2^-SUB_BUCKET_BITS (about 3%). Recording is wait-free and may happen concurrently with
+    // collect(); a value recorded during a resetting collect() is either reported now or in the next window.
+    class LatencyHistogram {
+        public:
+        static constexpr unsigned SUB_BUCKET_BITS = 5;
+        static constexpr unsigned MAX_EXPONENT = 40;  // values are clamped to about 18 minutes
+
+        struct Snapshot {
+            uint64_t count = 0;
+            uint64_t max_ns = 0;
+            double mean_ns = 0.0;
+            std::vector<uint64_t> buckets;
+
+            // Upper bound of the bucket containing the q-quantile, q in [0, 1].
+            uint64_t quantile_ns(double q) const;
+        };
+
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void record(uint64_t value_ns);
+
+        // Copy the current counts, optionally starting a new window.
+        Snapshot collect(bool reset);
+
+        static size_t bucket_index(uint64_t value_ns);
+        static uint64_t bucket_upper_bound(size_t index);
+
+        private:
+        static constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+        static constexpr size_t N_BUCKETS = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        std::array<std::atomic<uint64_t>, N_BUCKETS> buckets_;
+        std::atomic<uint64_t> sum_ns_{0};
+        std::atomic<uint64_t> max_ns_{0};
+    };
+
+    // Latency of the stages a frame passes on its way from the sensor to the subscribers.
+    struct FrameLatency {
+        enum Stage {
+            TRANSFER = 0,  // exposure (camera timestamp) to host arrival, only recorded with a PTP synchronized camera
+            DISPATCH,      // host arrival to pop in newBufferReady
+            PREPARATION,   // pop to conversion start
+            CONVERSION,    // conversion start to end
+            PUBLISH,       // conversion end to return of publish()
+            TOTAL,         // host arrival to return of publish()
+            N_STAGES
+        };
+
+        std::array<LatencyHistogram, N_STAGES> stages;
+
+        static const char* stage_name(Stage stage);
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
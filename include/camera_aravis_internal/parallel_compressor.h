@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_PARALLEL_COMPRESSOR_H
+#define CAMERA_ARAVIS_INTERNAL_PARALLEL_COMPRESSOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+
+#include <camera_aravis_internal/image_compression.h>
+#include <camera_aravis_internal/latency_histogram.h>
+
+namespace camera_aravis::internal {
+
+    // Compresses images on a pool of worker threads and hands the results out in submission order.
+    //
+    // Up to max_in_flight images are compressed or waiting at a time, so that consecutive frames are compressed in
+    // parallel while a single encoder would fall behind the frame rate. Images submitted beyond that are dropped
+    // instead of queueing up latency. The callback is invoked for one image at a time, on one of the workers; images
+    // which failed to compress are skipped.
+    class ParallelCompressor {
+        public:
+        struct Config {
+            CompressionOptions options;
+            size_t n_threads = 2;
+            size_t max_in_flight = 4;
+        };
+
+        struct Statistics {
+            uint64_t n_submitted = 0;
+            uint64_t n_compressed = 0;
+            uint64_t n_dropped = 0;  // submitted with max_in_flight images pending
+            uint64_t n_failed = 0;
+            size_t n_in_flight = 0;
+            // of the compressed images, for the ratio and the throughput of a worker
+            uint64_t n_bytes_raw = 0;
+            uint64_t n_bytes_compressed = 0;
+            uint64_t compression_ns = 0;
+        };
+
+        using Callback = std::function<void(const sensor_msgs::CompressedImagePtr&)>;
+
+        ParallelCompressor(const Config& config, Callback callback);
+        ~ParallelCompressor();
+
+        ParallelCompressor(const ParallelCompressor&) = delete;
+        ParallelCompressor& operator=(const ParallelCompressor&) = delete;
+
+        // Returns false if the image was dropped. The image must not change until it was compressed.
+        bool submit(const sensor_msgs::ImageConstPtr& image);
+
+        // Stop the workers, pending images are dropped.
+        void stop();
+
+        Statistics get_statistics() const;
+
+        // Time a worker spent compressing an image
+        LatencyHistogram& compression_time() { return compression_time_; }
+
+        private:
+        struct Job {
+            uint64_t sequence;
+            sensor_msgs::ImageConstPtr image;
+        };
+
+        void spin();
+
+        const Config config_;
+        const Callback callback_;
+        LatencyHistogram compression_time_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<Job> queue_;
+        // compressed images waiting for their predecessors, nullptr for failed ones
+        std::map<uint64_t, sensor_msgs::CompressedImagePtr> done_;
+        uint64_t next_sequence_ = 0;
+        uint64_t next_output_ = 0;
+        bool delivering_ = false;
+        bool running_ = true;
+        Statistics statistics_;
+        std::vector<std::thread> workers_;
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_PREVIEW_BINNING_H
+#define CAMERA_ARAVIS_INTERNAL_PREVIEW_BINNING_H
+
+#include <cstdint>
+#include <string>
+
+#include <sensor_msgs/Image.h>
+
+namespace camera_aravis::internal {
+
+    // Downscale an image by averaging blocks of factor x factor samples per channel, for preview outputs.
+    //
+    // Bayer images stay Bayer images with the same pattern: each output sample averages the factor x factor samples
+    // of its color in a block of 2 factor x 2 factor input samples, so colors do not bleed into each other. Takes 8
+    // and 16 bit mono, color and Bayer images and factors up to 32; samples which do not fill a block are left out.
+    // The rows are summed with SSE2 or NEON where available.
+    bool binImage(const sensor_msgs::Image& image, uint32_t factor, sensor_msgs::Image& binned, std::string& error);
+
+}  // namespace camera_aravis::internal
+
+#endif
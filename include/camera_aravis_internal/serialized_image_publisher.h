@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_SERIALIZED_IMAGE_PUBLISHER_H
+#define CAMERA_ARAVIS_INTERNAL_SERIALIZED_IMAGE_PUBLISHER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <ros/ros.h>
+#include <sensor_msgs/Image.h>
+
+namespace camera_aravis::internal {
+
+    // Publisher of sensor_msgs/Image which serializes each image once into a pooled buffer.
+    //
+    // roscpp serializes a published message into a freshly allocated buffer, several megabytes per frame. Here the
+    // image is serialized into a buffer of a pool instead, with the pixel data contiguous behind the fields of the
+    // message, and the connections of all remote subscribers send from that buffer; it returns to the pool once the
+    // last one is done. The publisher shares the publication of an existing publisher of the topic (e.g. the raw
+    // image_transport publisher).
+    //
+    // Subscribers in the same process would have to deserialize such a message instead of receiving the shared
+    // pointer, so only publish through this while there are none (see getNumLocalSubscribers()).
+    class SerializedImagePublisher {
+        public:
+        SerializedImagePublisher(ros::NodeHandle& nh, const std::string& topic);
+        ~SerializedImagePublisher();
+
+        SerializedImagePublisher(const SerializedImagePublisher&) = delete;
+        SerializedImagePublisher& operator=(const SerializedImagePublisher&) = delete;
+
+        void publish(const sensor_msgs::Image& image);
+
+        uint32_t getNumLocalSubscribers() const;
+        uint32_t getNumRemoteSubscribers() const;
+
+        // Buffers of the pool
+        size_t getAllocatedSize() const;
+        size_t getUsedSize() const;
+
+        private:
+        class Pool;
+        struct Subscribers {
+            std::atomic<uint32_t> n_local{0};
+            std::atomic<uint32_t> n_remote{0};
+        };
+
+        std::shared_ptr<Pool> pool_;
+        std::shared_ptr<Subscribers> subscribers_;  // shared with the connection callbacks
+        ros::Publisher publisher_;
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_SHM_IMAGE_RING_H
+#define CAMERA_ARAVIS_INTERNAL_SHM_IMAGE_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <sys/types.h>
+
+namespace camera_aravis::internal {
+
+    // Ring of image slots in a POSIX shared memory object, written by the driver and read by other processes.
+    //
+    // Only a descriptor (slot and sequence number) of a written image is sent over ROS. A reader acquires the slot by
+    // incrementing its reference count, which fails if the slot has been rewritten since, and releases it when done.
+    // The writer only reuses slots without references, and drops a frame if there is none. Readers map the slot data
+    // read-only, only the slot headers with the reference counts are writable.
+    //
+    // A reader which dies while holding a slot leaks that slot until the writer recreates the ring, which it does
+    // whenever a larger slot size is needed. Recreating changes the generation, readers have to open the ring again.
+    class ShmImageRing {
+        public:
+        struct Statistics {
+            uint64_t n_written = 0;
+            uint64_t n_full = 0;  // frames dropped because every slot was held by readers
+        };
+
+        ~ShmImageRing();
+
+        ShmImageRing(const ShmImageRing&) = delete;
+        ShmImageRing& operator=(const ShmImageRing&) = delete;
+
+        // Create the shared memory object (replacing a stale one of the same name) as writer, with the permissions
+        // of mode regardless of the umask. Readers need read and write access, they count their references in the
+        // ring. Returns null and fills error on failure.
+        static std::unique_ptr<ShmImageRing> create(const std::string& name, uint32_t n_slots, size_t slot_size,
+                                                    mode_t mode, std::string& error);
+
+        // Map an existing ring as reader
+        static std::unique_ptr<ShmImageRing> open(const std::string& name, std::string& error);
+
+        // Name of the shared memory object for the image topic
+        static std::string object_name(const std::string& topic);
+
+        const std::string& name() const { return name_; }
+        uint64_t generation() const;
+        uint32_t n_slots() const;
+        size_t slot_size() const;
+
+        // Writer: copy an image into a free slot. Returns false if size exceeds the slot size or no slot is free.
+        bool write(const uint8_t* data, size_t size, uint32_t& slot, uint64_t& sequence);
+        Statistics get_statistics() const;
+
+        // Reader: the data of a slot as written with sequence, null if it is gone. Must be released once done.
+        const uint8_t* acquire(uint32_t slot, uint64_t sequence, size_t& size);
+        void release(uint32_t slot);
+
+        private:
+        struct Header;
+        struct SlotHeader;
+
+        ShmImageRing() = default;
+
+        bool map(int fd, size_t header_size, size_t total_size, bool writer, std::string& error);
+        SlotHeader& slot_header(uint32_t slot) const;
+        uint8_t* slot_data(uint32_t slot) const;
+
+        std::string name_;
+        bool writer_ = false;
+        Header* header_ = nullptr;
+        size_t header_size_ = 0;
+        uint8_t* data_ = nullptr;
+        size_t data_size_ = 0;
+        uint32_t next_slot_ = 0;  // writer only
+        std::atomic<uint64_t> n_written_{0};
+        std::atomic<uint64_t> n_full_{0};
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
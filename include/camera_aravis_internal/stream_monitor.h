@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_STREAM_MONITOR_H
+#define CAMERA_ARAVIS_INTERNAL_STREAM_MONITOR_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace camera_aravis::internal {
+
+    // Windowed throughput and timing metrics of a stream.
+    //
+    // Frames are recorded from the stream thread, windows are collected periodically from any other thread.
+    class StreamMonitor {
+        public:
+        // Cumulative counters as reported by aravis
+        struct Counters {
+            uint64_t n_completed = 0;
+            uint64_t n_failures = 0;
+            uint64_t n_underruns = 0;
+            uint64_t n_resent = 0;   // GigE Vision only
+            uint64_t n_missing = 0;  // GigE Vision only
+        };
+
+        // CPU time of the stream thread spent per frame in the stages of newBufferReady
+        enum CpuStage { CPU_POP = 0, CPU_CONVERSION, CPU_CAMERA_INFO, CPU_PUBLISH, N_CPU_STAGES };
+        using CpuTimes = std::array<uint64_t, N_CPU_STAGES>;
+
+        struct Window {
+            double duration_s = 0.0;
+            uint64_t n_frames = 0;
+            uint64_t n_bytes = 0;
+            // inter-frame interval of the buffer timestamps
+            double interval_mean_s = 0.0;
+            double interval_stddev_s = 0.0;
+            double interval_max_s = 0.0;
+            // increase of the aravis counters within the window
+            Counters delta;
+            // CPU time summed over the published frames of the window
+            uint64_t n_cpu_frames = 0;
+            CpuTimes cpu_ns = {};
+
+            double frame_rate() const { return duration_s > 0.0 ? n_frames / duration_s : 0.0; }
+            double bytes_rate() const { return duration_s > 0.0 ? n_bytes / duration_s : 0.0; }
+            double cpu_ms_per_frame(CpuStage stage) const {
+                return n_cpu_frames > 0 ? cpu_ns[stage] * 1e-6 / n_cpu_frames : 0.0;
+            }
+            uint64_t cpu_total_ns() const;
+        };
+
+        StreamMonitor();
+
+        void record_frame(uint64_t timestamp_ns, size_t n_bytes);
+        void record_cpu(const CpuTimes& cpu_ns);
+
+        // Close the current window and start a new one.
+        Window collect(const Counters& counters);
+
+        private:
+        std::mutex mutex_;
+        std::chrono::steady_clock::time_point window_start_;
+        Counters counters_;
+
+        uint64_t last_timestamp_ns_ = 0;
+        uint64_t n_frames_ = 0;
+        uint64_t n_bytes_ = 0;
+        uint64_t n_intervals_ = 0;
+        double interval_mean_s_ = 0.0;
+        double interval_m2_ = 0.0;  // sum of squared deviations (Welford)
+        double interval_max_s_ = 0.0;
+        uint64_t n_cpu_frames_ = 0;
+        CpuTimes cpu_ns_ = {};
+    };
+
+}  // namespace camera_aravis::internal
+
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_TRACE_H
+#define CAMERA_ARAVIS_INTERNAL_TRACE_H
+
+// Timeline tracing of the acquisition pipeline.
+//
+// Only compiled in with -DCAMERA_ARAVIS_ENABLE_TRACING=ON, otherwise all CA_TRACE_* macros expand to nothing.
+// Events are written to a ring buffer of the recording thread (no locks, no allocation after the first event of a
+// thread) and exported as Chrome trace JSON, which can be opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+//
+// Event names must be string literals (or otherwise outlive the trace).
+//
+//   CA_TRACE_SCOPE("convert");            // complete event spanning the enclosing scope
+//   CA_TRACE_INSTANT("buffer underrun");  // single point in time
+//   CA_TRACE_COUNTER("pool used", n);     // counter track
+
+#include <cstdint>
+#include <string>
+
+#ifdef CAMERA_ARAVIS_ENABLE_TRACING
+
+namespace camera_aravis::internal::trace {
+
+    uint64_t now_ns();
+
+    void record_complete(const char* name, uint64_t begin_ns, uint64_t end_ns);
+    void record_instant(const char* name);
+    void record_counter(const char* name, int64_t value);
+
+    // Write the events of all threads recorded so far as Chrome trace JSON. Returns false if the file could not be
+    // written. Events overwritten concurrently by a busy thread may be dropped from the export.
+    bool write_chrome_trace(const std::string& path);
+
+    class Scope {
+        public:
+        explicit Scope(const char* name): name_(name), begin_ns_(now_ns()) {}
+        ~Scope() { record_complete(name_, begin_ns_, now_ns()); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        private:
+        const char* name_;
+        uint64_t begin_ns_;
+    };
+
+}  // namespace camera_aravis::internal::trace
+
+#define CA_TRACE_CONCAT_IMPL(a, b) a##b
+#define CA_TRACE_CONCAT(a, b) CA_TRACE_CONCAT_IMPL(a, b)
+#define CA_TRACE_SCOPE(name) \
+    ::camera_aravis::internal::trace::Scope CA_TRACE_CONCAT(ca_trace_scope_, __LINE__)(name)
+#define CA_TRACE_INSTANT(name) ::camera_aravis::internal::trace::record_instant(name)
+#define CA_TRACE_COUNTER(name, value) ::camera_aravis::internal::trace::record_counter(name, value)
+
+#else
+
+#define CA_TRACE_SCOPE(name) \
+    do {                     \
+    } while (false)
+#define CA_TRACE_INSTANT(name) \
+    do {                       \
+    } while (false)
+#define CA_TRACE_COUNTER(name, value) \
+    do {                              \
+    } while (false)
+
+#endif
+
+#endif
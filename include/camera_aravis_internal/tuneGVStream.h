@@ -3,14 +3,35 @@
 #ifndef CAMERA_ARAVIS_INTERNAL_TUNE_GV_STREAM_H
 #define CAMERA_ARAVIS_INTERNAL_TUNE_GV_STREAM_H
 
+#include <camera_aravis_internal/aravis_abstraction.h>
 
 extern "C" {
 #include <arv.h>
 }
 
 namespace camera_aravis::internal {
+    // Receiver options of a GigEVision stream.
+    struct GvStreamOptions {
+        bool auto_socket_buffer = false;  // size the socket buffer from the payload
+        guint socket_buffer_size = 0;     // bytes, 0 for the system default, unused with auto_socket_buffer
+        bool packet_resend = true;
+        guint packet_timeout_ms = 40;     // wait for a missing packet before requesting a resend
+        guint frame_retention_ms = 200;   // wait for an incomplete frame before dropping it
+    };
+
     // Extra stream options for GigEVision streams.
-    void tuneGvStream(ArvGvStream* p_stream);
+    void tuneGvStream(ArvGvStream* p_stream, const GvStreamOptions& options = GvStreamOptions());
+
+    // Set the packet size of the selected stream channel: the given size if positive, otherwise the largest size
+    // which actually reaches the host (jumbo frames if the link supports them). Returns the packet size in use.
+    gint negotiatePacketSize(const NonOwnedGPtr<ArvCamera>& cam, gint packet_size);
+
+    // Whether this process may open a packet socket (CAP_NET_RAW), which aravis then uses to receive GVSP packets
+    // without a syscall per packet.
+    bool packetSocketAvailable();
+
+    // Number of GVSP packets, including leader and trailer, a payload is sent in.
+    guint64 packetsPerFrame(gint packet_size, gint64 n_bytes_payload);
 }  // namespace camera_aravis::internal
 
 #endif
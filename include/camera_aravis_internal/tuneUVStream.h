@@ -0,0 +1,29 @@
+#pragma once
+
+#ifndef CAMERA_ARAVIS_INTERNAL_TUNE_UV_STREAM_H
+#define CAMERA_ARAVIS_INTERNAL_TUNE_UV_STREAM_H
+
+#include <camera_aravis_internal/aravis_abstraction.h>
+#include <camera_aravis_internal/feature_value_cache.h>
+
+extern "C" {
+#include <arv.h>
+}
+
+namespace camera_aravis::internal {
+    // Transfer settings of a USB3Vision camera. Zero leaves the camera setting untouched.
+    //
+    // The transfer layout of the streaming interface (SIRM) is programmed by aravis when the stream starts, from
+    // the payload and the packet size of the stream channel, so the packet size is the handle on the transfer size.
+    struct UvStreamOptions {
+        gint64 channel_packet_size = 0;  // DeviceStreamChannelPacketSize (bytes)
+        gint64 throughput_limit = 0;     // DeviceLinkThroughputLimit (bytes/s)
+    };
+
+    // Apply the transfer settings before the stream of the selected channel is created. Written through the feature
+    // cache of the device, so that cached values stay coherent.
+    void tuneUvStream(const NonOwnedGPtr<ArvDevice>& dev, aravis::device::feature::ValueCache& features,
+                      const UvStreamOptions& options);
+}  // namespace camera_aravis::internal
+
+#endif
@@ -0,0 +1,117 @@
+/****************************************************************************
+ *
+ * camera_aravis
+ *
+ * Copyright © 2022 Fraunhofer IOSB and contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+
+#include <camera_aravis/camera_aravis_listener_nodelet.h>
+
+#include <pluginlib/class_list_macros.h>
+PLUGINLIB_EXPORT_CLASS(camera_aravis::CameraAravisListenerNodelet, nodelet::Nodelet)
+
+namespace camera_aravis {
+
+    CameraAravisListenerNodelet::~CameraAravisListenerNodelet() {
+        if (!receiver_) { return; }
+
+        receiver_->stop();
+        const internal::GvspReceiver::Statistics statistics = receiver_->get_statistics();
+        ROS_INFO("Completed frames  = %Lu", (unsigned long long) statistics.n_completed);
+        ROS_INFO("Incomplete frames = %Lu", (unsigned long long) statistics.n_incomplete);
+        ROS_INFO("Ignored packets   = %Lu", (unsigned long long) statistics.n_ignored);
+    }
+
+    void CameraAravisListenerNodelet::onInit() {
+        ros::NodeHandle pnh = getPrivateNodeHandle();
+
+        internal::GvspReceiver::Config config;
+        config.address = pnh.param<std::string>("multicast_address", config.address);
+        config.port = pnh.param<int>("multicast_port", 50000);
+        config.interface_address = pnh.param<std::string>("multicast_interface", config.interface_address);
+        config.socket_buffer_size = pnh.param<int>("socket_buffer_size", 16 << 20);
+
+        frame_id_ = pnh.param<std::string>("frame_id", getName());
+        pixel_format_ = pnh.param<std::string>("pixel_format", pixel_format_);
+        use_ptp_stamp_ = pnh.param<bool>("use_ptp_timestamp", use_ptp_stamp_);
+
+        const auto& iter = CONVERSIONS_DICTIONARY.find(pixel_format_);
+        if (iter != CONVERSIONS_DICTIONARY.end()) {
+            conversion_function_ = iter->second;
+        } else {
+            ROS_WARN_STREAM("There is no known conversion from '"
+                            << pixel_format_ << "' to a usual ROS image encoding, set ~pixel_format to the "
+                            << "PixelFormat of the camera.");
+        }
+
+        camera_info_manager_ = std::make_unique<camera_info_manager::CameraInfoManager>(
+            pnh, frame_id_, pnh.param<std::string>("camera_info_url", ""));
+
+        image_transport::ImageTransport p_transport(pnh);
+        camera_publisher_ = p_transport.advertiseCamera(ros::names::remap(getName() + "/image_raw"), 1);
+
+        image_pool_ = boost::make_shared<CameraBufferPool>(nullptr, 0, 0);
+        receiver_ = std::make_unique<internal::GvspReceiver>(
+            config, [this](internal::GvspReceiver::Frame& frame) { frameReceived(frame); });
+        std::string error;
+        if (!receiver_->start(error)) {
+            ROS_ERROR("Could not receive %s:%u: %s", config.address.c_str(), config.port, error.c_str());
+            receiver_.reset();
+            return;
+        }
+
+        ROS_INFO("Receiving the multicast stream %s:%u.", config.address.c_str(), config.port);
+    }
+
+    void CameraAravisListenerNodelet::frameReceived(internal::GvspReceiver::Frame& frame) {
+        if (camera_publisher_.getNumSubscribers() == 0) { return; }
+
+        // hand over the frame data for the data of a recycled image, which usually already has the size of the next
+        // frame and is overwritten by it
+        sensor_msgs::ImagePtr msg_ptr = image_pool_->getRecyclableImg();
+        msg_ptr->data.swap(frame.data);
+
+        // the camera timestamp is only comparable to host time if the camera clock is synchronized
+        msg_ptr->header.stamp.fromNSec(use_ptp_stamp_ ? frame.timestamp : frame.arrival_ns);
+        msg_ptr->header.seq = frame.block_id;
+        msg_ptr->header.frame_id = frame_id_;
+        msg_ptr->width = frame.width;
+        msg_ptr->height = frame.height;
+        msg_ptr->encoding = pixel_format_;
+        msg_ptr->step = (msg_ptr->width * ((frame.pixel_format >> 16) & 0xff)) / 8;
+
+        if (conversion_function_) {
+            sensor_msgs::ImagePtr cvt_msg_ptr = boost::make_shared<sensor_msgs::Image>();
+            conversion_function_(msg_ptr, cvt_msg_ptr);
+            msg_ptr = cvt_msg_ptr;
+        }
+
+        sensor_msgs::CameraInfoPtr camera_info =
+            boost::make_shared<sensor_msgs::CameraInfo>(camera_info_manager_->getCameraInfo());
+        camera_info->header = msg_ptr->header;
+        if (camera_info->width == 0 || camera_info->height == 0) {
+            camera_info->width = frame.width;
+            camera_info->height = frame.height;
+        }
+
+        camera_publisher_.publish(msg_ptr, camera_info);
+    }
+
+}  // end namespace camera_aravis
@@ -21,13 +21,21 @@
  *
  ****************************************************************************/
 
+#include <arpa/inet.h>
+
+#include <condition_variable>
+#include <ctime>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_set>
 
 #define ROS_ASSERT_ENABLED
 #include <ros/console.h>
 
 #include <camera_aravis/camera_aravis_nodelet.h>
+#include <camera_aravis/raw12_codec.h>
 
 #include <pluginlib/class_list_macros.h>
 PLUGINLIB_EXPORT_CLASS(camera_aravis::CameraAravisNodelet, nodelet::Nodelet)
@@ -37,7 +45,10 @@ PLUGINLIB_EXPORT_CLASS(camera_aravis::CameraAravisNodelet, nodelet::Nodelet)
 #include <camera_aravis_internal/GErrorROSLog.h>
 #include <camera_aravis_internal/aravis_abstraction.h>
 #include <camera_aravis_internal/discover_features.h>
+#include <camera_aravis_internal/hotpath_checks.h>
+#include <camera_aravis_internal/preview_binning.h>
 #include <camera_aravis_internal/resetPtpClock.h>
+#include <camera_aravis_internal/trace.h>
 #include <camera_aravis_internal/tuneGVStream.h>
 
 #include "diagnostic_updater/diagnostic_updater.h"
@@ -55,6 +66,20 @@ namespace camera_aravis {
         return std::string(cstr);
     }
 
+    // Host time in the clock domain of arv_buffer_get_system_timestamp()
+    guint64 host_time_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // CPU time consumed by the calling thread
+    guint64 thread_cpu_time_ns() {
+        timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) { return 0; }
+        return guint64(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+    }
+
     struct CameraAravisNodelet::DiagnosticsHandler {
         private:
         CameraAravisNodelet* parent;
@@ -64,21 +89,74 @@ namespace camera_aravis {
 
         ros::Timer timer;
 
+        // Device enumeration broadcasts on all interfaces, which is slow on GigE. It runs on its own thread at a low
+        // rate until the camera is open, the diagnostics task only reports the cached result.
+        std::mutex device_list_mutex;  // serializes all use of the aravis device list
+        std::condition_variable discovery_cv;
+        std::thread discovery_thread;
+        bool discovery_running = false;
+        ros::WallDuration discovery_period;
+        std::atomic<uint> n_interfaces{0};
+        std::atomic<uint> n_devices{0};
+        std::atomic<bool> discovery_done{false};
+        // set once the device and its control executor are set up, which publishes both to the diagnostics thread
+        std::atomic<bool> device_open{false};
+
+        // requires device_list_mutex
+        uint scan_devices() {
+            arv_update_device_list();
+            n_interfaces = arv_get_n_interfaces();
+            n_devices = arv_get_n_devices();
+            discovery_done = true;
+            return n_devices;
+        }
+
+        void discovery_loop() {
+            std::unique_lock<std::mutex> lock(device_list_mutex);
+            // started right after a scan of the start-up, so the first rescan is due one period later
+            while (!discovery_cv.wait_for(lock, std::chrono::duration<double>(discovery_period.toSec()),
+                                          [this]() { return !discovery_running; })) {
+                scan_devices();
+            }
+        }
+
+        void add_device_health(DiagnosticStatusWrapper& diag) {
+            diag.add("Device", parent->guid_.empty() ? "(any)" : parent->guid_);
+            diag.add("Control lost", bool(parent->control_lost_));
+
+            const bool executor_running = parent->control_executor_ && parent->control_executor_->is_running();
+            diag.add("Control channel executor running", executor_running);
+
+            if (parent->control_lost_) {
+                diag.summary(dm::DiagnosticStatus::ERROR, "Control to device lost");
+            } else if (parent->control_executor_ && !executor_running) {
+                diag.summary(dm::DiagnosticStatus::ERROR, "Control channel executor stopped");
+            } else {
+                diag.summary(dm::DiagnosticStatus::OK, "Device open");
+            }
+        }
+
         public:
         DiagnosticsHandler(CameraAravisNodelet* parent,
                            ros::NodeHandle nh = ros::NodeHandle(),
                            ros::NodeHandle pnh = ros::NodeHandle("~"),
                            const std::string& node_name = ros::this_node::getName()):
             parent(parent), updater(nh, pnh, node_name) {
+            discovery_period = ros::WallDuration(pnh.param<double>("device_discovery_period", 5.0));
+
             updater.add("Devices available", [&](DiagnosticStatusWrapper& diag) {
-                arv_update_device_list();
-                uint n_interfaces = arv_get_n_interfaces();
-                uint n_devices = arv_get_n_devices();
+                // once the camera is open, a bus rescan tells nothing about it
+                if (device_open) {
+                    add_device_health(diag);
+                    return;
+                }
 
-                diag.add("Interfaces available", n_interfaces);
-                diag.add("Devices available", n_devices);
+                diag.add("Interfaces available", uint(n_interfaces));
+                diag.add("Devices available", uint(n_devices));
 
-                if (n_interfaces < 1) {
+                if (!discovery_done) {
+                    diag.summary(dm::DiagnosticStatus::WARN, "Device discovery pending");
+                } else if (n_interfaces < 1) {
                     diag.summary(dm::DiagnosticStatus::ERROR, "No genicam interfaces available");
                 } else if (n_devices < 1) {
                     diag.summary(dm::DiagnosticStatus::ERROR, "No genicam devices available");
@@ -92,29 +170,87 @@ namespace camera_aravis {
                 false);
         }
 
+        ~DiagnosticsHandler() { stop_discovery(); }
+
         du::Updater& get_updater() { return updater; }
 
+        void start_discovery() {
+            std::lock_guard<std::mutex> lock(device_list_mutex);
+            if (discovery_running) { return; }
+            discovery_running = true;
+            discovery_thread = std::thread(&DiagnosticsHandler::discovery_loop, this);
+        }
+
+        void stop_discovery() {
+            {
+                std::lock_guard<std::mutex> lock(device_list_mutex);
+                discovery_running = false;
+            }
+            discovery_cv.notify_all();
+            if (discovery_thread.joinable()) { discovery_thread.join(); }
+        }
+
+        // Rescan now and wait for the result.
+        uint discover_devices() {
+            std::lock_guard<std::mutex> lock(device_list_mutex);
+            return scan_devices();
+        }
+
+        uint get_n_interfaces() const { return n_interfaces; }
+
+        // Hold off background enumeration while using the aravis device list (or opening a device).
+        std::unique_lock<std::mutex> lock_device_list() { return std::unique_lock<std::mutex>(device_list_mutex); }
+
         void start_publishing() { timer.start(); }
 
         void stop_publishing() { timer.stop(); }
 
         bool has_feature(const std::string& feature) {
-            return parent->implemented_features_.find(feature) != parent->implemented_features_.end();
+            return parent->isImplemented(feature);
+        }
+
+        // Every read is queued separately, so that triggers can overtake a long diagnostics update
+        template<typename F>
+        auto control(F&& fn) -> decltype(fn()) {
+            return parent->control(internal::ControlExecutor::DIAGNOSTICS, std::forward<F>(fn));
+        }
+
+        std::string get_string_feature(const std::string& feature) {
+            return control([&]() {
+                if (parent->feature_cache_) { return parent->feature_cache_->read_string(feature.c_str()); }
+                return a2s(aravis::device::feature::get_string(parent->device, feature.c_str()));
+            });
         }
 
         void add_string_feature(DiagnosticStatusWrapper& diag, const std::string& title, const std::string& feature) {
             if (!has_feature(feature)) { return; }
-            diag.add(title, a2s(aravis::device::feature::get_string(parent->device, feature.c_str())));
+            diag.add(title, get_string_feature(feature));
         }
 
         void add_integer_feature(DiagnosticStatusWrapper& diag, const std::string& title, const std::string& feature) {
             if (!has_feature(feature)) { return; }
-            diag.add(title, aravis::device::feature::get_integer(parent->device, feature.c_str()));
+            diag.add(title, control([&]() {
+                         if (parent->feature_cache_) { return parent->feature_cache_->read_integer(feature.c_str()); }
+                         return aravis::device::feature::get_integer(parent->device, feature.c_str());
+                     }));
         }
 
         void add_float_feature(DiagnosticStatusWrapper& diag, const std::string& title, const std::string& feature) {
             if (!has_feature(feature)) { return; }
-            diag.add(title, aravis::device::feature::get_float(parent->device, feature.c_str()));
+            diag.add(title, control([&]() {
+                         if (parent->feature_cache_) { return parent->feature_cache_->read_float(feature.c_str()); }
+                         return aravis::device::feature::get_float(parent->device, feature.c_str());
+                     }));
+        }
+
+        void add_feature_cache_statistics(DiagnosticStatusWrapper& diag) {
+            if (!parent->feature_cache_) { return; }
+            const auto stats = parent->feature_cache_->get_statistics();
+            diag.add("Feature cache hits", stats.hits);
+            diag.add("Feature cache misses", stats.misses);
+            diag.add("Feature cache uncachable reads", stats.uncachable);
+            diag.add("Feature cache invalidations", stats.invalidations);
+            diag.addf("Feature cache hit rate (%)", "%.1f", 100.0 * stats.hit_rate());
         }
 
         void setup_camera_seach(const std::string& guid) {
@@ -123,7 +259,7 @@ namespace camera_aravis {
             camera_search_added = true;
 
             updater.add("Camera search", [&](DiagnosticStatusWrapper& diag) {
-                bool has_camera = bool(parent->camera);
+                const bool has_camera = device_open;
 
                 diag.add("Camera to seach", guid);
 
@@ -133,25 +269,30 @@ namespace camera_aravis {
                 }
 
                 if (has_camera) {
-                    diag.add("Camera user id", a2s(aravis::camera::get_user_id(parent->camera)));
-                    diag.add("Camera serial number", a2s(aravis::camera::get_serial_number(parent->camera)));
-                    diag.add("Camera model name", a2s(aravis::camera::get_model_name(parent->camera)));
+                    diag.add("Camera user id",
+                             control([&]() { return a2s(aravis::camera::get_user_id(parent->camera)); }));
+                    diag.add("Camera serial number",
+                             control([&]() { return a2s(aravis::camera::get_serial_number(parent->camera)); }));
+                    diag.add("Camera model name",
+                             control([&]() { return a2s(aravis::camera::get_model_name(parent->camera)); }));
                     add_string_feature(diag, "Camera family name", "DeviceFamilyName");
                     add_string_feature(diag, "Camera version", "DeviceVersion");
                     add_string_feature(diag, "Camera firmware", "DeviceFirmwareVersion");
-                    diag.add("Camera vendor name", a2s(aravis::camera::get_vendor_name(parent->camera)));
+                    diag.add("Camera vendor name",
+                             control([&]() { return a2s(aravis::camera::get_vendor_name(parent->camera)); }));
                     add_string_feature(diag, "Camera manufacturer info", "DeviceManufacturerInfo");
 
                     add_integer_feature(diag, "Camera link speed (Bps)", "DeviceLinkSpeed");
                     add_float_feature(diag, "Camera temperature (C)", "DeviceTemperature");
+
+                    add_feature_cache_statistics(diag);
                 }
 
                 // IDS Specific
                 if (has_feature("DeviceBootStatus")) {
                     add_string_feature(diag, "Camera boot status", "DeviceBootStatus");
 
-                    const std::string val =
-                        a2s(aravis::device::feature::get_string(parent->device, "DeviceBootStatus"));
+                    const std::string val = get_string_feature("DeviceBootStatus");
 
                     if (!val.empty() && val != "OK") {
                         add_integer_feature(diag, "Camera boot status additional info 1",
@@ -168,6 +309,37 @@ namespace camera_aravis {
             });
         }
 
+        void setup_control_channel() {
+            device_open = true;
+
+            updater.add("Control channel", [&](DiagnosticStatusWrapper& diag) {
+                if (!parent->control_executor_) { return; }
+
+                double max_trigger_latency_ms = 0.0;
+                for (int p = 0; p < internal::ControlExecutor::N_PRIORITIES; ++p) {
+                    const auto priority = static_cast<internal::ControlExecutor::Priority>(p);
+                    const std::string name = internal::ControlExecutor::priority_name(priority);
+                    const auto stats = parent->control_executor_->get_statistics(priority);
+
+                    diag.add(name + " requests", stats.n_requests);
+                    diag.add(name + " pending", stats.n_pending);
+                    diag.addf(name + " mean queue latency (ms)", "%.3f", stats.mean_latency_ms);
+                    diag.addf(name + " max queue latency (ms)", "%.3f", stats.max_latency_ms);
+
+                    if (priority == internal::ControlExecutor::TRIGGER) {
+                        max_trigger_latency_ms = stats.max_latency_ms;
+                    }
+                }
+
+                if (!parent->control_executor_->is_running()) {
+                    diag.summary(dm::DiagnosticStatus::ERROR, "Control channel executor stopped");
+                } else {
+                    diag.summaryf(dm::DiagnosticStatus::OK, "Max trigger queue latency %.3f ms",
+                                  max_trigger_latency_ms);
+                }
+            });
+        }
+
         void setup_stream(int stream_idx) {
             const std::string stream_name = parent->streams_[stream_idx].name.empty()
                                                 ? ("Stream " + std::to_string(stream_idx))
@@ -202,6 +374,116 @@ namespace camera_aravis {
                 add_integer_feature(diag, "Payload size (B)", "PayloadSize");
                 add_integer_feature(diag, "Channel packet size (B)", "DeviceStreamChannelPacketSize");
 
+                if (parent->stream_statistics_rate_ > 0.0) {
+                    StreamStatistics stats;
+                    {
+                        std::lock_guard<std::mutex> lock(parent->stream_statistics_mutex_);
+                        stats = parent->streams_[stream_idx].last_statistics;
+                    }
+
+                    diag.addf("Frame rate (Hz)", "%.2f (configured %.2f)", stats.frame_rate,
+                              stats.configured_frame_rate);
+                    if (stats.link_utilization > 0.0) {
+                        diag.addf("Throughput (MB/s)", "%.2f (%.1f %% of the link)", stats.throughput,
+                                  stats.link_utilization * 1e2);
+                    } else {
+                        diag.addf("Throughput (MB/s)", "%.2f", stats.throughput);
+                    }
+                    diag.addf("Frame interval (ms)", "mean %.3f, jitter %.3f, max %.3f", stats.interval_mean,
+                              stats.interval_jitter, stats.interval_max);
+                    if (aravis::device::is_gv(parent->device)) {
+                        diag.addf("Resent packets (1/s)", "%.1f", stats.resent_packets_rate);
+                        diag.addf("Missing packets (1/s)", "%.1f", stats.missing_packets_rate);
+                    }
+                    diag.addf("Buffer pool used", "%u of %u", stats.pool_used, stats.pool_allocated);
+                    diag.addf("CPU per frame (ms)", "%.3f (pop %.3f, conversion %.3f, camera info %.3f, publish %.3f)",
+                              stats.cpu_per_frame, stats.cpu_pop, stats.cpu_conversion, stats.cpu_camera_info,
+                              stats.cpu_publish);
+                    diag.addf("CPU load (ms/s)", "%.1f", stats.cpu_load);
+                }
+
+                if (parent->streams_[stream_idx].serialized_publisher) {
+                    const internal::SerializedImagePublisher& serialized =
+                        *parent->streams_[stream_idx].serialized_publisher;
+                    diag.addf("Serialized image buffers", "%lu of %lu used",
+                              static_cast<unsigned long>(serialized.getUsedSize()),
+                              static_cast<unsigned long>(serialized.getAllocatedSize()));
+                }
+
+                auto add_compression = [&diag](const std::string& name, internal::ParallelCompressor& compressor) {
+                    const internal::ParallelCompressor::Statistics stats = compressor.get_statistics();
+                    const auto snapshot = compressor.compression_time().collect(true);
+                    if (snapshot.count > 0) {
+                        diag.addf(name + " time (ms)", "p50 %.3f, p99 %.3f, max %.3f",
+                                  snapshot.quantile_ns(0.5) * 1e-6, snapshot.quantile_ns(0.99) * 1e-6,
+                                  snapshot.max_ns * 1e-6);
+                    }
+                    diag.addf(name + " images", "%lu (%lu dropped, %lu failed)",
+                              static_cast<unsigned long>(stats.n_compressed),
+                              static_cast<unsigned long>(stats.n_dropped), static_cast<unsigned long>(stats.n_failed));
+                    if (stats.n_bytes_compressed > 0 && stats.compression_ns > 0) {
+                        diag.addf(name + " ratio", "%.2f (%.1f MB/s per thread)",
+                                  static_cast<double>(stats.n_bytes_raw) / stats.n_bytes_compressed,
+                                  stats.n_bytes_raw * 1e3 / stats.compression_ns);
+                    }
+                };
+                if (parent->streams_[stream_idx].compressor) {
+                    add_compression("Compression", *parent->streams_[stream_idx].compressor);
+                }
+                if (parent->streams_[stream_idx].raw12_compressor) {
+                    add_compression("Raw12 compression", *parent->streams_[stream_idx].raw12_compressor);
+                }
+
+                if (parent->streams_[stream_idx].preview_time) {
+                    const auto snapshot = parent->streams_[stream_idx].preview_time->collect(true);
+                    if (snapshot.count > 0) {
+                        diag.addf("Preview binning (ms)", "p50 %.3f, p99 %.3f, max %.3f",
+                                  snapshot.quantile_ns(0.5) * 1e-6, snapshot.quantile_ns(0.99) * 1e-6,
+                                  snapshot.max_ns * 1e-6);
+                    }
+                }
+
+                if (parent->streams_[stream_idx].frame_sets) {
+                    const Stream& stream = parent->streams_[stream_idx];
+                    const FrameSetAssembler::Statistics sets =
+                        stream.frame_sets->get_statistics(stream.frame_set_source);
+                    diag.addf("Frame sets", "%lu of %lu frames matched", static_cast<unsigned long>(sets.n_matched),
+                              static_cast<unsigned long>(sets.n_frames));
+                    diag.addf("Frame sets dropped", "%lu timed out, %lu overwritten, %lu skipped",
+                              static_cast<unsigned long>(sets.n_timed_out),
+                              static_cast<unsigned long>(sets.n_overwritten),
+                              static_cast<unsigned long>(sets.n_skipped));
+                }
+
+                if (parent->streams_[stream_idx].clock) {
+                    const internal::ClockEstimator::Statistics clock =
+                        parent->streams_[stream_idx].clock->get_statistics();
+                    if (clock.valid) {
+                        diag.addf("Clock offset (s)", "%.6f", clock.offset_s);
+                        diag.addf("Clock drift (ppm)", "%.3f", clock.drift_ppm);
+                        diag.addf("Clock residuals (us)", "stddev %.1f, max %.1f", clock.residual_stddev_s * 1e6,
+                                  clock.residual_max_s * 1e6);
+                    } else {
+                        diag.add("Clock offset (s)", "estimating");
+                    }
+                    diag.addf("Clock resets", "%lu", static_cast<unsigned long>(clock.n_resets));
+                    if (parent->latched_clock_) {
+                        diag.addf("Clock latch round trip (us)", "%.1f", parent->latch_round_trip_ns_ * 1e-3);
+                    }
+                }
+
+                // frame latency since the previous update
+                internal::FrameLatency& latency = *parent->streams_[stream_idx].latency;
+                for (int s = 0; s < internal::FrameLatency::N_STAGES; ++s) {
+                    const auto stage = static_cast<internal::FrameLatency::Stage>(s);
+                    const auto snapshot = latency.stages[stage].collect(true);
+                    if (snapshot.count == 0) { continue; }
+
+                    diag.addf(std::string(internal::FrameLatency::stage_name(stage)) + " latency (ms)",
+                              "p50 %.3f, p99 %.3f, max %.3f", snapshot.quantile_ns(0.5) * 1e-6,
+                              snapshot.quantile_ns(0.99) * 1e-6, snapshot.max_ns * 1e-6);
+                }
+
                 if (n_failures > 0) {
                     diag.summaryf(dm::DiagnosticStatus::ERROR, "%" G_GUINT64_FORMAT " Failures detected", n_failures);
                 } else if (n_underruns > 0) {
@@ -219,9 +501,17 @@ namespace camera_aravis {
 
         for (int i = 0; i < streams_.size(); i++) {
             if (streams_[i].arv_stream) { arv_stream_set_emit_signals(streams_[i].arv_stream.get(), FALSE); }
+            // the cameras of the group must not publish into our streams anymore
+            if (streams_[i].frame_sets) { streams_[i].frame_sets->remove_source(streams_[i].frame_set_source); }
+            // pending images hold buffers of the stream
+            if (streams_[i].compressor) { streams_[i].compressor->stop(); }
+            if (streams_[i].raw12_compressor) { streams_[i].raw12_compressor->stop(); }
         }
 
         software_trigger_timer_.stop();
+        stream_statistics_timer_.stop();
+        frame_set_timer_.stop();
+        timestamp_latch_timer_.stop();
 
         spawning_ = false;
         if (spawn_stream_thread_.joinable()) { spawn_stream_thread_.join(); }
@@ -246,9 +536,35 @@ namespace camera_aravis {
 
 
         if (device) {
-            aravis::device::execute_command(device, "AcquisitionStop");
-            aravis::device::execute_command(device, "DeviceReset");
+            control(internal::ControlExecutor::ACQUISITION, [&]() {
+                executeCommand("AcquisitionStop");
+                executeCommand("DeviceReset");
+            });
+        }
+
+        for (uint64_t id : bandwidth_members_) { internal::BandwidthScheduler::instance().remove(id); }
+        bandwidth_members_.clear();
+
+        if (control_executor_) { control_executor_->stop(); }
+
+#ifdef CAMERA_ARAVIS_HOTPATH_CHECKS
+        const internal::hotpath::Statistics hotpath_stats = internal::hotpath::get_statistics();
+        ROS_INFO("Hot path frames      = %Lu", (unsigned long long) hotpath_stats.n_frames);
+        ROS_INFO("Hot path allocations = %Lu", (unsigned long long) hotpath_stats.n_allocations);
+        ROS_INFO("Hot path lock waits  = %Lu (max %.1f us)", (unsigned long long) hotpath_stats.n_lock_waits,
+                 hotpath_stats.max_lock_wait_ns * 1e-3);
+        ROS_INFO("Hot path violations  = %Lu", (unsigned long long) hotpath_stats.n_violations);
+#endif
+
+#ifdef CAMERA_ARAVIS_ENABLE_TRACING
+        if (!trace_file_.empty()) {
+            if (internal::trace::write_chrome_trace(trace_file_)) {
+                ROS_INFO("Trace written to %s", trace_file_.c_str());
+            } else {
+                ROS_ERROR("Failed to write trace to %s", trace_file_.c_str());
+            }
         }
+#endif
     }
 
 #if ARAVIS_HAS_USB_MODE
@@ -291,6 +607,113 @@ namespace camera_aravis {
         // Get the camera guid as a parameter or use the first device.
         guid_ = pnh.param<std::string>("guid", guid_);
         use_ptp_stamp_ = pnh.param<bool>("use_ptp_timestamp", use_ptp_stamp_);
+        // host: arrival time, device: camera clock (synchronized by PTP), fused: camera clock mapped onto host time,
+        // latched: the same, calibrated by latching the camera clock
+        const std::string timestamp_mode = pnh.param<std::string>("timestamp_mode", use_ptp_stamp_ ? "device" : "host");
+        if (timestamp_mode != "host" && timestamp_mode != "device" && timestamp_mode != "fused" &&
+            timestamp_mode != "latched") {
+            ROS_WARN("Unknown timestamp_mode '%s' (host, device, fused or latched), using host",
+                     timestamp_mode.c_str());
+        }
+        use_ptp_stamp_ = timestamp_mode == "device";
+        fuse_timestamps_ = timestamp_mode == "fused" || timestamp_mode == "latched";
+        latch_timestamps_ = timestamp_mode == "latched";
+        timestamp_latch_period_ = pnh.param<double>("timestamp_latch_period", timestamp_latch_period_);
+        publish_frame_timing_ = pnh.param<bool>("publish_frame_timing", publish_frame_timing_);
+        stream_statistics_rate_ = pnh.param<double>("stream_statistics_rate", stream_statistics_rate_);
+        trace_file_ = pnh.param<std::string>("trace_file", trace_file_);
+        // "mtu" is the name used by earlier configurations
+        packet_size_ = pnh.param<int>("packet_size", pnh.param<int>("mtu", packet_size_));
+
+        n_stream_buffers_ = std::max(1, pnh.param<int>("stream_buffer_count", n_stream_buffers_));
+        shm_transport_ = pnh.param<bool>("shm_transport", shm_transport_);
+        preserialized_publishing_ = pnh.param<bool>("preserialized_publishing", preserialized_publishing_);
+        n_shm_slots_ = std::max(1, pnh.param<int>("shm_slots", n_shm_slots_));
+        {
+            // octal, as for chmod
+            const std::string mode = pnh.param<std::string>("shm_mode", "0600");
+            char* end = nullptr;
+            const long value = strtol(mode.c_str(), &end, 8);
+            if (mode.empty() || *end != '\0' || value < 0 || value > 0777) {
+                ROS_WARN("Invalid shm_mode '%s' (octal permissions, e.g. 0660), using 0600", mode.c_str());
+            } else {
+                shm_mode_ = static_cast<mode_t>(value);
+            }
+        }
+        compression_format_ = pnh.param<std::string>("compression_format", compression_format_);
+        if (!compression_format_.empty() && compression_format_ != "jpeg" && compression_format_ != "png") {
+            ROS_WARN("Unknown compression_format '%s' (jpeg or png), compressed output disabled",
+                     compression_format_.c_str());
+            compression_format_.clear();
+        }
+        compression_config_.options.format =
+            compression_format_ == "png" ? internal::CompressionOptions::PNG : internal::CompressionOptions::JPEG;
+        compression_config_.options.jpeg_quality =
+            std::clamp(pnh.param<int>("jpeg_quality", compression_config_.options.jpeg_quality), 1, 100);
+        compression_config_.options.png_level =
+            std::clamp(pnh.param<int>("png_level", compression_config_.options.png_level), 0, 9);
+        compression_config_.n_threads = std::max(1, pnh.param<int>("compression_threads", 2));
+        // each frame in flight holds a stream buffer
+        compression_config_.max_in_flight =
+            std::max(1, pnh.param<int>("compression_queue", 2 * static_cast<int>(compression_config_.n_threads)));
+        raw12_compression_ = pnh.param<bool>("raw12_compression", raw12_compression_);
+        preview_binning_ = std::clamp(pnh.param<int>("preview_binning", preview_binning_), 0, 32);
+        preview_rate_ = std::max(0.0, pnh.param<double>("preview_rate", preview_rate_));
+        uv_stream_options_.channel_packet_size = pnh.param<int>("usb_channel_packet_size", 0);
+        uv_stream_options_.throughput_limit = static_cast<gint64>(pnh.param<double>("usb_throughput_limit", 0.0));
+        gv_packet_socket_ = pnh.param<bool>("gv_packet_socket", gv_packet_socket_);
+        multicast_address_ = pnh.param<std::string>("multicast_address", multicast_address_);
+        multicast_port_ = pnh.param<int>("multicast_port", multicast_port_);
+        gv_stream_options_.auto_socket_buffer = pnh.param<bool>("gv_auto_socket_buffer", false);
+        gv_stream_options_.socket_buffer_size = std::max(0, pnh.param<int>("gv_socket_buffer_size", 0));
+        gv_stream_options_.packet_resend = pnh.param<bool>("gv_packet_resend", gv_stream_options_.packet_resend);
+        gv_stream_options_.packet_timeout_ms =
+            std::max(1, pnh.param<int>("gv_packet_timeout_ms", gv_stream_options_.packet_timeout_ms));
+        gv_stream_options_.frame_retention_ms =
+            std::max(1, pnh.param<int>("gv_frame_retention_ms", gv_stream_options_.frame_retention_ms));
+
+        gv_stream_tuning_ = pnh.param<bool>("gv_stream_tuning", gv_stream_tuning_);
+        gv_tuning_bounds_.max_socket_buffer_size =
+            std::max(0, pnh.param<int>("gv_tuning_max_socket_buffer_size", gv_tuning_bounds_.max_socket_buffer_size));
+        gv_tuning_bounds_.min_packet_timeout_ms =
+            std::max(1, pnh.param<int>("gv_tuning_min_packet_timeout_ms", gv_tuning_bounds_.min_packet_timeout_ms));
+        gv_tuning_bounds_.max_packet_timeout_ms =
+            std::max(1, pnh.param<int>("gv_tuning_max_packet_timeout_ms", gv_tuning_bounds_.max_packet_timeout_ms));
+        gv_tuning_bounds_.min_frame_retention_ms =
+            std::max(1, pnh.param<int>("gv_tuning_min_frame_retention_ms", gv_tuning_bounds_.min_frame_retention_ms));
+        gv_tuning_bounds_.max_frame_retention_ms =
+            std::max(1, pnh.param<int>("gv_tuning_max_frame_retention_ms", gv_tuning_bounds_.max_frame_retention_ms));
+        bandwidth_scheduling_ = pnh.param<bool>("bandwidth_scheduling", bandwidth_scheduling_);
+        bandwidth_link_speed_ = pnh.param<double>("bandwidth_link_speed_mbps", bandwidth_link_speed_ * 1e-6) * 1e6;
+        bandwidth_utilization_ = pnh.param<double>("bandwidth_utilization", bandwidth_utilization_);
+
+        // match the frames of the streams, and of the cameras in the same frame_set_group, into sets
+        frame_set_group_ = pnh.param<std::string>("frame_set_group", frame_set_group_);
+        if (pnh.param<bool>("frame_sets", !frame_set_group_.empty())) {
+            // frame ids only agree between the streams of one camera
+            FrameSetAssembler::Config config;
+            config.match_frame_id =
+                pnh.param<std::string>("frame_set_match", frame_set_group_.empty() ? "frame_id" : "timestamp") ==
+                "frame_id";
+            config.tolerance_ns = pnh.param<double>("frame_set_tolerance", config.tolerance_ns * 1e-9) * 1e9;
+            config.timeout_ns = pnh.param<double>("frame_set_timeout", config.timeout_ns * 1e-9) * 1e9;
+            config.ring_size = std::max(1, pnh.param<int>("frame_set_ring_size", static_cast<int>(config.ring_size)));
+            frame_sets_ = frame_set_group_.empty() ? std::make_shared<FrameSetAssembler>(config)
+                                                   : sharedFrameSetAssembler(frame_set_group_, config);
+        }
+
+        if (gv_stream_tuning_ && stream_statistics_rate_ <= 0.0) {
+            ROS_WARN("gv_stream_tuning needs the stream statistics, set stream_statistics_rate > 0");
+        }
+
+#ifdef CAMERA_ARAVIS_HOTPATH_CHECKS
+        internal::hotpath::Config hotpath_config;
+        hotpath_config.warmup_frames = pnh.param<int>("hotpath_warmup_frames", hotpath_config.warmup_frames);
+        hotpath_config.max_lock_wait_ns =
+            pnh.param<double>("hotpath_max_lock_wait_us", hotpath_config.max_lock_wait_ns * 1e-3) * 1e3;
+        hotpath_config.abort_on_violation = pnh.param<bool>("hotpath_abort", hotpath_config.abort_on_violation);
+        internal::hotpath::configure(hotpath_config);
+#endif
 
         double software_trigger_rate = pnh.param<double>("software_trigger_rate", 0);
         frame_id_ = get_tf_prefix(pnh) + pnh.param<std::string>("frame_id", frame_id_);
@@ -319,17 +742,15 @@ namespace camera_aravis {
 
         // Print out some useful info.
         ROS_INFO("Attached cameras:");
-        arv_update_device_list();
-        uint n_interfaces = arv_get_n_interfaces();
-        ROS_INFO("# Interfaces: %d", n_interfaces);
+        uint n_devices = diagnostics_handler->discover_devices();
+        ROS_INFO("# Interfaces: %d", diagnostics_handler->get_n_interfaces());
 
-        uint n_devices = arv_get_n_devices();
         for (int i = 5; i > 0; --i) {
             if (n_devices == 0) {
                 ROS_ERROR("No cameras detected, retrying in 1s ...");
                 diagnostics_handler->get_updater().force_update();
                 ros::Duration(1.0).sleep();
-                n_devices = arv_get_n_devices();
+                n_devices = diagnostics_handler->discover_devices();
             }
         }
 
@@ -341,21 +762,34 @@ namespace camera_aravis {
         diagnostics_handler->setup_camera_seach(guid_);
 
         ROS_INFO("# Devices: %d", n_devices);
-        for (uint i = 0; i < n_devices; i++) ROS_INFO("Device%d: %s", i, arv_get_device_id(i));
+        {
+            const auto lock = diagnostics_handler->lock_device_list();
+            for (uint i = 0; i < n_devices; i++) ROS_INFO("Device%d: %s", i, arv_get_device_id(i));
+        }
+
+        // keep the device count in the diagnostics current while waiting for the camera
+        diagnostics_handler->start_discovery();
 
         // Open the camera, and set it up.
         while (!camera) {
-            if (guid_.empty()) {
-                ROS_INFO("Opening: (any)");
-                camera = aravis::camera_new();
-            } else {
-                ROS_INFO_STREAM("Opening: " << guid_);
-                camera = aravis::camera_new(guid_.c_str());
+            {
+                // opening may enumerate the devices as well
+                const auto lock = diagnostics_handler->lock_device_list();
+                if (guid_.empty()) {
+                    ROS_INFO("Opening: (any)");
+                    camera = aravis::camera_new();
+                } else {
+                    ROS_INFO_STREAM("Opening: " << guid_);
+                    camera = aravis::camera_new(guid_.c_str());
+                }
             }
             diagnostics_handler->get_updater().force_update();
             ros::Duration(1.0).sleep();
         }
 
+        // from here on the diagnostics monitor the open device instead of the bus
+        diagnostics_handler->stop_discovery();
+
         device = aravis::camera::get_device(camera);
         ROS_INFO("Opened: %s-%s", aravis::camera::get_vendor_name(camera),
                  aravis::device::feature::get_string(device, "DeviceSerialNumber"));
@@ -387,7 +821,7 @@ namespace camera_aravis {
             if (pnh.getParam("UserSetSelector", user_set)) {
                 aravis::device::feature::set_string(device, "UserSetSelector", user_set.c_str());
             }
-            aravis::device::execute_command(device, "UserSetLoad");
+            executeCommand("UserSetLoad");
         }
 
         aravis::camera::bounds::get_width(camera, &roi_.width_min, &roi_.width_max);
@@ -452,15 +886,15 @@ namespace camera_aravis {
             }
 
             // Start the camerainfo manager.
-            std::string camera_info_frame_id = frame_id_;
-            if (!stream_names_[i].empty()) camera_info_frame_id = frame_id_ + '/' + stream_names_[i];
+            stream.frame_id = frame_id_;
+            if (!stream_names_[i].empty()) stream.frame_id = frame_id_ + '/' + stream_names_[i];
 
             stream.camera_info_node_handle = pnh;
             // Use separate node handles for CameraInfoManagers when using a Multisource Camera
             if (!stream_names_[i].empty()) { stream.camera_info_node_handle = ros::NodeHandle(pnh, stream_names_[i]); }
 
             stream.camera_info_manager = std::make_unique<camera_info_manager::CameraInfoManager>(
-                stream.camera_info_node_handle, camera_info_frame_id, calib_urls[i]);
+                stream.camera_info_node_handle, stream.frame_id, calib_urls[i]);
 
 
             ROS_INFO("Reset %s Camera Info Manager", stream_names_[i].c_str());
@@ -470,6 +904,13 @@ namespace camera_aravis {
         // get current state of camera for config_
         aravis::camera::get_region(camera, &roi_.x, &roi_.y, &roi_.width, &roi_.height);
 
+        // all initial writes are done, from here on feature access goes through the cache
+        feature_cache_ = std::make_unique<aravis::device::feature::ValueCache>(device);
+
+        // from here on the device is shared by several threads
+        control_executor_ = std::make_unique<internal::ControlExecutor>();
+        diagnostics_handler->setup_control_channel();
+
         // Print information.
         print_capabilities();
 
@@ -477,6 +918,11 @@ namespace camera_aravis {
         // Reset PTP clock
         if (use_ptp_stamp_) { internal::resetPtpClock(device); }
 
+        if (!multicast_address_.empty() && !aravis::device::is_gv(device)) {
+            ROS_WARN("multicast_address needs a GigE Vision camera, streaming to this host");
+            multicast_address_.clear();
+        }
+
         // spawn camera stream in thread, so onInit() is not blocked
         spawning_ = true;
         spawn_stream_thread_ = std::thread(&CameraAravisNodelet::spawnStream, this);
@@ -488,10 +934,11 @@ namespace camera_aravis {
 
                 software_trigger_timer_ =
                     pnh.createTimer(ros::Duration(ros::Rate(software_trigger_rate)), [&](const ros::TimerEvent& evt) {
-                        if (std::any_of(streams_.cbegin(), streams_.cend(), [](const Stream& stream) {
-                                return stream.camera_publisher.getNumSubscribers() > 0;
-                            })) {
-                            aravis::device::execute_command(device, "TriggerSoftware");
+                        if (!multicast_address_.empty() ||
+                            std::any_of(streams_.cbegin(), streams_.cend(), isSubscribed)) {
+                            control_executor_->post(internal::ControlExecutor::TRIGGER, [this]() {
+                                executeCommand("TriggerSoftware");
+                            });
                             ROS_ERROR("Software trigger");
                         }
 
@@ -523,12 +970,75 @@ namespace camera_aravis {
 
         image_transport::ImageTransport p_transport(pnh);
 
+        // a multicast controller only configures and runs the camera, its own streams receive nothing
+        const bool multicast_controller = !multicast_address_.empty();
+
+        if (latch_timestamps_ && !multicast_controller) {
+            if (isImplemented("TimestampLatch") && isImplemented("TimestampLatchValue")) {
+                latch_command_ = "TimestampLatch";
+                latch_value_ = "TimestampLatchValue";
+            } else if (isImplemented("GevTimestampControlLatch") && isImplemented("GevTimestampValue")) {
+                // in ticks
+                latch_command_ = "GevTimestampControlLatch";
+                latch_value_ = "GevTimestampValue";
+                if (isImplemented("GevTimestampTickFrequency")) {
+                    latch_tick_frequency_ = control(internal::ControlExecutor::ACQUISITION, [&]() {
+                        return aravis::device::feature::get_integer(device, "GevTimestampTickFrequency");
+                    });
+                }
+            }
+
+            if (latch_command_.empty() || latch_tick_frequency_ <= 0) {
+                ROS_WARN("Camera cannot latch its timestamp, estimating the clock from the frames instead");
+            } else {
+                // every latch is an exact sample up to the round trip, fit to the median and with each one
+                latched_clock_ = std::make_shared<internal::ClockEstimator>(64, 0.5, 1);
+            }
+        }
+
+        if (aravis::device::is_gv(device)) {
+            // aravis tries a packet socket by default, decide up front for a defined fallback
+            const bool packet_socket = gv_packet_socket_ && internal::packetSocketAvailable();
+            if (gv_packet_socket_ && !packet_socket) {
+                ROS_WARN("Packet socket not permitted (needs CAP_NET_RAW), falling back to UDP sockets");
+            }
+            control(internal::ControlExecutor::ACQUISITION, [&]() {
+                aravis::device::GigEVision::set_stream_options(
+                    device, packet_socket ? ARV_GV_STREAM_OPTION_NONE : ARV_GV_STREAM_OPTION_PACKET_SOCKET_DISABLED);
+            });
+            ROS_INFO("GigE Vision streams receive through %s", packet_socket ? "a packet socket" : "UDP sockets");
+        }
+
         for (int i = 0; i < num_streams_; i++) {
             Stream& stream = streams_[i];
-            while (spawning_) {
-                if (aravis::device::is_gv(device)) { aravis::camera::gv::select_stream_channel(camera, i); }
+            if (latched_clock_) {
+                stream.clock = latched_clock_;
+                stream.clock_from_frames = false;
+            } else if (fuse_timestamps_ && !multicast_controller) {
+                stream.clock = std::make_shared<internal::ClockEstimator>();
+            }
+
+            // before creating the stream, which sizes its packet handling from the current setting
+            gint packet_size = 0;
+            if (aravis::device::is_gv(device)) {
+                packet_size = control(internal::ControlExecutor::ACQUISITION, [&]() {
+                    selectStreamChannel(i);
+                    const gint res = internal::negotiatePacketSize(camera, packet_size_);
+                    feature_cache_->invalidate("GevSCPSPacketSize");
+                    return res;
+                });
+            }
 
-                stream.arv_stream = aravis::camera::create_stream(camera, NULL, NULL);
+            if (aravis::device::is_uv(device)) {
+                control(internal::ControlExecutor::ACQUISITION,
+                        [&]() { internal::tuneUvStream(device, *feature_cache_, uv_stream_options_); });
+            }
+
+            while (spawning_) {
+                stream.arv_stream = control(internal::ControlExecutor::ACQUISITION, [&]() {
+                    if (aravis::device::is_gv(device)) { selectStreamChannel(i); }
+                    return aravis::camera::create_stream(camera, NULL, NULL);
+                });
 
                 if (stream.arv_stream) { break; }
 
@@ -538,23 +1048,122 @@ namespace camera_aravis {
             }
 
             // Load up some buffers.
-            if (aravis::device::is_gv(device)) aravis::camera::gv::select_stream_channel(camera, i);
+            const gint64 n_bytes_payload_stream = control(internal::ControlExecutor::ACQUISITION, [&]() {
+                if (aravis::device::is_gv(device)) selectStreamChannel(i);
+                return aravis::camera::get_payload(camera);
+            });
 
-            const gint64 n_bytes_payload_stream = aravis::camera::get_payload(camera);
+            if (packet_size > 0) {
+                ROS_INFO("Stream %i: packet size %d bytes (%s), %lu packets per frame", i, packet_size,
+                         packet_size_ > 0 ? "configured" : "negotiated",
+                         static_cast<unsigned long>(internal::packetsPerFrame(packet_size, n_bytes_payload_stream)));
+                if (bandwidth_scheduling_) { scheduleBandwidth(i, packet_size, n_bytes_payload_stream); }
+            }
 
-            stream.buffer_pool = boost::make_shared<CameraBufferPool>(stream.arv_stream.get(), n_bytes_payload_stream, 10);
+            stream.buffer_pool = boost::make_shared<CameraBufferPool>(
+                stream.arv_stream.get(), n_bytes_payload_stream, multicast_controller ? 0 : n_stream_buffers_);
 
             if (aravis::device::is_gv(device)) {
-                internal::tuneGvStream(reinterpret_cast<ArvGvStream*>(stream.arv_stream.get()));
+                internal::tuneGvStream(reinterpret_cast<ArvGvStream*>(stream.arv_stream.get()), gv_stream_options_);
+                stream.gv_options = gv_stream_options_;
+                if (gv_stream_tuning_ && !multicast_controller) {
+                    stream.gv_tuner = std::make_unique<internal::GvStreamTuner>(gv_stream_options_, gv_tuning_bounds_);
+                }
+            }
+
+            if (multicast_controller) {
+                // the frames are published by CameraAravisListenerNodelet, on this host as well
+                setMulticastDestination(i);
+                continue;
             }
 
             // Set up image_raw
             std::string topic_name = this->getName();
             if (num_streams_ != 1 || !stream_names_[i].empty()) { topic_name += "/" + stream_names_[i]; }
 
+            if (!compression_format_.empty()) {
+                // the compressed plugin of image_transport would compress on the thread of newBufferReady
+                const std::string key =
+                    pnh.resolveName(ros::names::remap(topic_name + "/image_raw")) + "/disable_pub_plugins";
+                std::vector<std::string> disabled;
+                pnh.getParam(key, disabled);
+                if (std::find(disabled.begin(), disabled.end(), "image_transport/compressed") == disabled.end()) {
+                    disabled.push_back("image_transport/compressed");
+                    pnh.setParam(key, disabled);
+                }
+            }
+
             stream.camera_publisher = p_transport.advertiseCamera(ros::names::remap(topic_name + "/image_raw"), 1,
                                                                   image_cb, image_cb, info_cb, info_cb);
 
+            if (preserialized_publishing_) {
+                // share the publications of camera_publisher
+                stream.serialized_publisher =
+                    std::make_unique<internal::SerializedImagePublisher>(pnh, stream.camera_publisher.getTopic());
+                stream.camera_info_publisher =
+                    pnh.advertise<sensor_msgs::CameraInfo>(stream.camera_publisher.getInfoTopic(), 1);
+            }
+
+            if (!compression_format_.empty()) {
+                stream.compressed_publisher = pnh.advertise<sensor_msgs::CompressedImage>(
+                    stream.camera_publisher.getTopic() + "/compressed", 1, info_cb, info_cb);
+                auto publish = [publisher = stream.compressed_publisher](const sensor_msgs::CompressedImagePtr& image) {
+                    publisher.publish(image);
+                };
+                stream.compressor = std::make_unique<internal::ParallelCompressor>(compression_config_, publish);
+            }
+
+            if (raw12_compression_ && isRaw12Format(stream.sensor_description.pixel_format)) {
+                stream.raw12_publisher = pnh.advertise<sensor_msgs::CompressedImage>(
+                    stream.camera_publisher.getTopic() + "/raw12", 1, info_cb, info_cb);
+                internal::ParallelCompressor::Config config = compression_config_;
+                config.options.format = internal::CompressionOptions::RAW12;
+                auto publish = [publisher = stream.raw12_publisher](const sensor_msgs::CompressedImagePtr& image) {
+                    publisher.publish(image);
+                };
+                stream.raw12_compressor = std::make_unique<internal::ParallelCompressor>(config, publish);
+            } else if (raw12_compression_) {
+                ROS_WARN("raw12_compression needs a packed 12 bit pixel format (e.g. BayerRG12p), not %s",
+                         stream.sensor_description.pixel_format.c_str());
+            }
+
+            if (preview_binning_ > 0) {
+                stream.preview_publisher = p_transport.advertiseCamera(
+                    ros::names::remap(topic_name + "/preview/image_raw"), 1, image_cb, image_cb, info_cb, info_cb);
+                stream.preview_binning = static_cast<uint32_t>(preview_binning_);
+                stream.preview_interval_ns = preview_rate_ > 0.0 ? static_cast<uint64_t>(1e9 / preview_rate_) : 0;
+                stream.preview_time = std::make_unique<internal::LatencyHistogram>();
+            }
+
+            if (publish_frame_timing_) {
+                stream.frame_timing_publisher =
+                    pnh.advertise<FrameTiming>(ros::names::remap(topic_name + "/frame_timing"), 10);
+            }
+
+            if (stream_statistics_rate_ > 0.0) {
+                stream.statistics_publisher =
+                    pnh.advertise<StreamStatistics>(ros::names::remap(topic_name + "/stream_statistics"), 10);
+            }
+
+            if (shm_transport_) {
+                // for consumers in other processes, only a descriptor is sent over ROS
+                stream.shm_publisher =
+                    pnh.advertise<ShmImage>(ros::names::remap(topic_name + "/image_shm"), 10, info_cb, info_cb);
+                stream.shm_name = internal::ShmImageRing::object_name(stream.shm_publisher.getTopic());
+                stream.n_shm_slots = n_shm_slots_;
+                stream.shm_mode = shm_mode_;
+            }
+
+            if (frame_sets_) {
+                if (!frame_set_publisher_) {
+                    frame_set_publisher_ =
+                        pnh.advertise<FrameSet>(ros::names::remap(this->getName() + "/frame_set"), 10);
+                }
+                stream.frame_sets = frame_sets_;
+                stream.frame_set_source = frame_sets_->add_source();
+                stream.frame_set_publisher = frame_set_publisher_;
+            }
+
             // Connect signals with callbacks.
             g_signal_connect(
                 stream.arv_stream.get(), "new-buffer",
@@ -565,14 +1174,17 @@ namespace camera_aravis {
 
                         Stream& stream = data->can->streams_[data->stream_id];
 
-                        const std::string stream_frame_id =
-                            stream.name.empty() ? data->can->frame_id_ : data->can->frame_id_ + "/" + stream.name;
-
-                        newBufferReady(stream, stream_frame_id, data->can->roi_.width, data->can->roi_.height,
+                        newBufferReady(stream, stream.frame_id, data->can->roi_.width, data->can->roi_.height,
                                        data->can->use_ptp_stamp_);
 
                         // check PTP status, camera cannot recover from "Faulty" by itself
-                        if (data->can->use_ptp_stamp_) internal::resetPtpClock(data->can->device);
+                        if (data->can->use_ptp_stamp_ && !data->can->ptp_check_pending_.exchange(true)) {
+                            CameraAravisNodelet* can = data->can;
+                            can->control_executor_->post(internal::ControlExecutor::DIAGNOSTICS, [can]() {
+                                internal::resetPtpClock(can->device);
+                                can->ptp_check_pending_ = false;
+                            });
+                        }
                     },
                 &(stream_ids_[i]));
 
@@ -580,11 +1192,43 @@ namespace camera_aravis {
         }
         g_signal_connect(device.get(), "control-lost", (GCallback) CameraAravisNodelet::controlLostCallback, this);
 
-        for (int i = 0; i < num_streams_; i++) { arv_stream_set_emit_signals(streams_[i].arv_stream.get(), TRUE); }
+        if (frame_sets_ && !multicast_controller) {
+            // frames of a stalled camera would hold their buffers until the next frame of the group arrives
+            const double period = std::max(frame_sets_->config().timeout_ns * 0.5e-9, 0.001);
+            frame_set_timer_ = pnh.createWallTimer(ros::WallDuration(period),
+                                                   [this](const ros::WallTimerEvent&) { frame_sets_->expire(); });
+        }
 
-        if (std::any_of(streams_.cbegin(), streams_.cend(),
-                        [](const Stream& stream) { return stream.camera_publisher.getNumSubscribers() > 0; })) {
-            aravis::camera::start_acquisition(camera);
+        if (stream_statistics_rate_ > 0.0 && !multicast_controller) {
+            stream_statistics_timer_ = pnh.createTimer(ros::Duration(ros::Rate(stream_statistics_rate_)),
+                                                       [this](const ros::TimerEvent&) { updateStreamStatistics(); });
+        }
+
+        if (latched_clock_) {
+            auto latch = [this]() {
+                if (latch_pending_.exchange(true)) { return; }
+                control_executor_->post(internal::ControlExecutor::DIAGNOSTICS, [this]() {
+                    latchTimestamp();
+                    latch_pending_ = false;
+                });
+            };
+            latch();
+            timestamp_latch_timer_ =
+                pnh.createTimer(ros::Duration(timestamp_latch_period_), [latch](const ros::TimerEvent&) { latch(); });
+        }
+
+        if (!multicast_controller) {
+            for (int i = 0; i < num_streams_; i++) { arv_stream_set_emit_signals(streams_[i].arv_stream.get(), TRUE); }
+        }
+
+        // listeners of a multicast stream are not known here, so it is sent continuously
+        if (multicast_controller ||
+            std::any_of(streams_.cbegin(), streams_.cend(), isSubscribed)) {
+            control(internal::ControlExecutor::ACQUISITION, [&]() {
+                aravis::camera::start_acquisition(camera);
+                // a command outside the cache, see executeCommand()
+                feature_cache_->clear();
+            });
         }
 
         this->get_integer_service_ =
@@ -608,46 +1252,97 @@ namespace camera_aravis {
         this->exec_command_service_ =
             pnh.advertiseService("execute_command", &CameraAravisNodelet::executeCommandCallback, this);
 
+        this->get_features_service_ =
+            pnh.advertiseService("get_features", &CameraAravisNodelet::getFeaturesCallback, this);
+        this->set_features_service_ =
+            pnh.advertiseService("set_features", &CameraAravisNodelet::setFeaturesCallback, this);
+
+#ifdef CAMERA_ARAVIS_ENABLE_TRACING
+        this->write_trace_service_ =
+            pnh.advertiseService("write_trace", &CameraAravisNodelet::writeTraceCallback, this);
+#endif
+
+        setupFeatureWatch(pnh);
+
         diagnostics_handler->start_publishing();
         ROS_INFO("Done initializing camera_aravis.");
     }
 
     void CameraAravisNodelet::rosConnectCallback() {
-        if (static_cast<bool>(device)) {
-            if (std::all_of(streams_.cbegin(), streams_.cend(),
-                            [](const Stream& stream) { return stream.camera_publisher.getNumSubscribers() == 0; })) {
-                // don't waste CPU if nobody is listening!
-                aravis::device::execute_command(device, "AcquisitionStop");
+        if (static_cast<bool>(device) && multicast_address_.empty()) {
+            // don't waste CPU if nobody is listening!
+            const char* cmd = std::none_of(streams_.cbegin(), streams_.cend(), isSubscribed) ? "AcquisitionStop"
+                                                                                              : "AcquisitionStart";
+
+            if (control_executor_) {
+                control_executor_->post(internal::ControlExecutor::ACQUISITION,
+                                        [this, cmd]() { executeCommand(cmd); });
             } else {
-                aravis::device::execute_command(device, "AcquisitionStart");
+                executeCommand(cmd);
             }
         }
     }
 
     void CameraAravisNodelet::newBufferReady(Stream& stream,
-                                             std::string frame_id,
+                                             const std::string& frame_id,
                                              int32_t width,
                                              int32_t height,
                                              bool use_ptp_stamp) {
+        CA_TRACE_SCOPE("newBufferReady");
+        // pop, wrapping and conversion must neither allocate nor block, CameraInfo and publish are out of our hands
+        CA_HOTPATH_BEGIN(hotpath, "newBufferReady");
+        const guint64 cpu_start = thread_cpu_time_ns();
+
         ArvBuffer* p_buffer = arv_stream_try_pop_buffer(stream.arv_stream.get());
+        const guint64 t_pop = host_time_ns();
 
         // check if we risk to drop the next image because of not enough buffers left
         gint n_available_buffers;
         arv_stream_get_n_buffers(stream.arv_stream.get(), &n_available_buffers, NULL);
 
 
-        if (n_available_buffers == 0) { stream.buffer_pool->allocateBuffers(1); }
+        if (n_available_buffers == 0) {
+            CA_TRACE_INSTANT("buffer underrun");
+            stream.buffer_pool->allocateBuffers(1);
+        }
 
         if (p_buffer == NULL) { return; }
 
-        if (arv_buffer_get_status(p_buffer) != ARV_BUFFER_STATUS_SUCCESS || !stream.buffer_pool ||
-            stream.camera_publisher.getNumSubscribers() == 0) {
-            if (arv_buffer_get_status(p_buffer) != ARV_BUFFER_STATUS_SUCCESS) {
-                ROS_WARN("(%s) Buffer error: %s", frame_id.c_str(),
-                         aravis::buffer::status_string(arv_buffer_get_status(p_buffer)));
-            }
+        // the camera timestamp is only comparable to host time if the camera clock is synchronized, or mapped
+        const guint64 t_camera = arv_buffer_get_timestamp(p_buffer);
+        const guint64 t_arrival = arv_buffer_get_system_timestamp(p_buffer);
+        guint64 t_fused = 0;
+        if (stream.clock && t_camera > 0 && t_arrival > 0) {
+            t_fused =
+                stream.clock_from_frames ? stream.clock->update(t_camera, t_arrival) : stream.clock->map(t_camera);
+        }
+        const guint64 t_exposure = use_ptp_stamp ? t_camera : t_fused;
+        // stamp of the image message
+        guint64 t = (use_ptp_stamp) ? t_camera : t_arrival;
+        if (t_fused > 0) { t = t_fused; }
+        const guint64 frame_number = arv_buffer_get_frame_id(p_buffer);
+
+        // all delivered frames count for the stream metrics, also if nobody is listening
+        if (arv_buffer_get_status(p_buffer) == ARV_BUFFER_STATUS_SUCCESS) {
+            size_t n_bytes = 0;
+            arv_buffer_get_data(p_buffer, &n_bytes);
+            stream.monitor->record_frame(t_camera > 0 ? t_camera : t_arrival, n_bytes);
+        }
 
+        const bool subscribed = isSubscribed(stream);
+        const ArvBufferStatus status = arv_buffer_get_status(p_buffer);
+        if (status != ARV_BUFFER_STATUS_SUCCESS || !stream.buffer_pool || !subscribed) {
             arv_stream_push_buffer(stream.arv_stream.get(), p_buffer);
+            // nothing is published, as for a published frame the frame set is joined off the hot path
+            CA_HOTPATH_END(hotpath);
+
+            if (status != ARV_BUFFER_STATUS_SUCCESS) {
+                ROS_WARN("(%s) Buffer error: %s", frame_id.c_str(), aravis::buffer::status_string(status));
+            } else if (stream.frame_sets) {
+                // nobody listens to this stream, but the sets of the others wait for it
+                stream.frame_sets->add(stream.frame_set_source, frame_number, t,
+                                       FrameSetMember{&stream, nullptr, nullptr}, publishFrameSet);
+            }
             return;
         }
 
@@ -655,12 +1350,9 @@ namespace camera_aravis {
         sensor_msgs::ImagePtr msg_ptr = (*(stream.buffer_pool))[p_buffer];
 
         // fill the meta information of image message
-        // get acquisition time
-        guint64 t = (use_ptp_stamp) ? arv_buffer_get_timestamp(p_buffer) : arv_buffer_get_system_timestamp(p_buffer);
-
         msg_ptr->header.stamp.fromNSec(t);
         // get frame sequence number
-        msg_ptr->header.seq = arv_buffer_get_frame_id(p_buffer);
+        msg_ptr->header.seq = frame_number;
         // fill other stream properties
         msg_ptr->header.frame_id = frame_id;
         msg_ptr->width = width;
@@ -668,12 +1360,27 @@ namespace camera_aravis {
         msg_ptr->encoding = stream.sensor_description.pixel_format;
         msg_ptr->step = (msg_ptr->width * stream.sensor_description.n_bits_pixel) / 8;
 
+        // the packed image as it arrived, handed to the compressor once off the hot path
+        const sensor_msgs::ImagePtr raw_msg_ptr = msg_ptr;
+
         // do the magic of conversion into a ROS format
+        const guint64 cpu_conversion_start = thread_cpu_time_ns();
+        const guint64 t_conversion_start = host_time_ns();
         if (stream.conversion_function) {
+            CA_TRACE_SCOPE("convert");
+            CA_HOTPATH_SCOPE("conversion");
             sensor_msgs::ImagePtr cvt_msg_ptr = stream.buffer_pool->getRecyclableImg();
             stream.conversion_function(msg_ptr, cvt_msg_ptr);
             msg_ptr = cvt_msg_ptr;
         }
+        const guint64 t_conversion_end = host_time_ns();
+        const guint64 cpu_conversion_end = thread_cpu_time_ns();
+        CA_HOTPATH_END(hotpath);
+
+        // the compressor queue locks and allocates
+        if (stream.raw12_compressor && stream.raw12_publisher.getNumSubscribers() > 0) {
+            stream.raw12_compressor->submit(raw_msg_ptr);
+        }
 
         // get current CameraInfo data
         stream.camera_info = boost::make_shared<sensor_msgs::CameraInfo>(stream.camera_info_manager->getCameraInfo());
@@ -692,12 +1399,402 @@ namespace camera_aravis {
             stream.camera_info->height = height;
         }
 
-        stream.camera_publisher.publish(msg_ptr, stream.camera_info);
+        const guint64 cpu_publish_start = thread_cpu_time_ns();
+        // a frame set may be published by the thread of another stream
+        const std_msgs::Header header = msg_ptr->header;
+        if (stream.frame_sets) {
+            CA_TRACE_SCOPE("frame set");
+            stream.frame_sets->add(stream.frame_set_source, frame_number, t,
+                                   FrameSetMember{&stream, msg_ptr, stream.camera_info}, publishFrameSet);
+        } else {
+            publishImage(stream, msg_ptr, stream.camera_info);
+        }
+        const guint64 t_published = host_time_ns();
+        const guint64 cpu_published = thread_cpu_time_ns();
+
+        stream.monitor->record_cpu({cpu_conversion_start - cpu_start, cpu_conversion_end - cpu_conversion_start,
+                                    cpu_publish_start - cpu_conversion_end, cpu_published - cpu_publish_start});
+
+        internal::FrameLatency& latency = *stream.latency;
+        // the system clock may be stepped, stages running backwards are skipped
+        auto record = [&latency](internal::FrameLatency::Stage stage, guint64 from, guint64 to) {
+            if (from > 0 && to >= from) { latency.stages[stage].record(to - from); }
+        };
+        record(internal::FrameLatency::TRANSFER, t_exposure, t_arrival);
+        record(internal::FrameLatency::DISPATCH, t_arrival, t_pop);
+        record(internal::FrameLatency::PREPARATION, t_pop, t_conversion_start);
+        record(internal::FrameLatency::CONVERSION, t_conversion_start, t_conversion_end);
+        record(internal::FrameLatency::PUBLISH, t_conversion_end, t_published);
+        record(internal::FrameLatency::TOTAL, t_arrival, t_published);
+
+        if (stream.frame_timing_publisher && stream.frame_timing_publisher.getNumSubscribers() > 0) {
+            FrameTimingPtr timing = boost::make_shared<FrameTiming>();
+            timing->header = header;
+            timing->exposure = t_exposure;
+            timing->arrival = t_arrival;
+            timing->pop = t_pop;
+            timing->conversion_start = t_conversion_start;
+            timing->conversion_end = t_conversion_end;
+            timing->published = t_published;
+            stream.frame_timing_publisher.publish(timing);
+        }
+
+        CA_HOTPATH_FRAME_DONE();
+    }
+
+    bool CameraAravisNodelet::isSubscribed(const Stream& stream) {
+        return stream.camera_publisher.getNumSubscribers() > 0 ||
+               (stream.shm_publisher && stream.shm_publisher.getNumSubscribers() > 0) ||
+               (stream.compressed_publisher && stream.compressed_publisher.getNumSubscribers() > 0) ||
+               (stream.raw12_publisher && stream.raw12_publisher.getNumSubscribers() > 0) ||
+               (stream.preview_publisher && stream.preview_publisher.getNumSubscribers() > 0);
+    }
+
+    void CameraAravisNodelet::publishImage(Stream& stream, const sensor_msgs::ImagePtr& image,
+                                           const sensor_msgs::CameraInfoPtr& camera_info) {
+        // camera_publisher counts the subscribers of the image on all transports and of the camera info, if these are
+        // all remote subscribers of the raw image, they can share one serialization
+        const internal::SerializedImagePublisher* serialized = stream.serialized_publisher.get();
+        if (serialized && serialized->getNumLocalSubscribers() == 0 && serialized->getNumRemoteSubscribers() > 0 &&
+            stream.camera_publisher.getNumSubscribers() == serialized->getNumRemoteSubscribers()) {
+            CA_TRACE_SCOPE("publish");
+            stream.serialized_publisher->publish(*image);
+            stream.camera_info_publisher.publish(camera_info);
+        } else {
+            CA_TRACE_SCOPE("publish");
+            stream.camera_publisher.publish(image, camera_info);
+        }
+
+        // compressed on the workers, the image must stay as it is from here on
+        if (stream.compressor && stream.compressed_publisher.getNumSubscribers() > 0) {
+            stream.compressor->submit(image);
+        }
+
+        if (stream.preview_publisher && stream.preview_publisher.getNumSubscribers() > 0) {
+            publishPreview(stream, *image, *camera_info);
+        }
+
+        if (!stream.shm_publisher || stream.shm_publisher.getNumSubscribers() == 0) { return; }
+
+        CA_TRACE_SCOPE("publish shared memory");
+        const size_t size = image->data.size();
+        if (!stream.shm_ring || stream.shm_ring->slot_size() < size) {
+            // the old ring goes first, it unlinks the name; its readers keep their mapping
+            stream.shm_ring.reset();
+            std::string error;
+            stream.shm_ring =
+                internal::ShmImageRing::create(stream.shm_name, stream.n_shm_slots, size, stream.shm_mode, error);
+            if (!stream.shm_ring) {
+                ROS_ERROR_THROTTLE(5.0, "Cannot create shared memory %s: %s", stream.shm_name.c_str(), error.c_str());
+                return;
+            }
+            ROS_INFO("Publishing %s through shared memory %s, %u slots of %lu bytes",
+                     stream.shm_publisher.getTopic().c_str(), stream.shm_name.c_str(), stream.n_shm_slots,
+                     static_cast<unsigned long>(stream.shm_ring->slot_size()));
+        }
+
+        uint32_t slot;
+        uint64_t sequence;
+        if (!stream.shm_ring->write(image->data.data(), size, slot, sequence)) {
+            ROS_WARN_THROTTLE(5.0, "%s: all shared memory slots held by readers, %lu images dropped",
+                              stream.shm_publisher.getTopic().c_str(),
+                              static_cast<unsigned long>(stream.shm_ring->get_statistics().n_full));
+            return;
+        }
+
+        ShmImagePtr descriptor = boost::make_shared<ShmImage>();
+        descriptor->header = image->header;
+        descriptor->height = image->height;
+        descriptor->width = image->width;
+        descriptor->encoding = image->encoding;
+        descriptor->is_bigendian = image->is_bigendian;
+        descriptor->step = image->step;
+        descriptor->region = stream.shm_name;
+        descriptor->generation = stream.shm_ring->generation();
+        descriptor->slot = slot;
+        descriptor->sequence = sequence;
+        stream.shm_publisher.publish(descriptor);
+    }
+
+    void CameraAravisNodelet::publishPreview(Stream& stream, const sensor_msgs::Image& image,
+                                             const sensor_msgs::CameraInfo& camera_info) {
+        const guint64 t_begin = host_time_ns();
+        if (stream.last_preview_ns != 0 && t_begin - stream.last_preview_ns < stream.preview_interval_ns) { return; }
+        stream.last_preview_ns = t_begin;
+
+        CA_TRACE_SCOPE("publish preview");
+        sensor_msgs::ImagePtr preview = stream.buffer_pool->getRecyclableImg();
+        std::string error;
+        if (!binImage(image, stream.preview_binning, *preview, error)) {
+            ROS_WARN_THROTTLE(5.0, "%s: no preview, %s", stream.preview_publisher.getTopic().c_str(), error.c_str());
+            return;
+        }
+        preview->header = image.header;
+
+        // binning_x/y tell image_geometry to scale the calibration
+        sensor_msgs::CameraInfoPtr preview_info = boost::make_shared<sensor_msgs::CameraInfo>(camera_info);
+        preview_info->binning_x = std::max<uint32_t>(1, camera_info.binning_x) * stream.preview_binning;
+        preview_info->binning_y = std::max<uint32_t>(1, camera_info.binning_y) * stream.preview_binning;
+        stream.preview_time->record(host_time_ns() - t_begin);
+
+        stream.preview_publisher.publish(preview, preview_info);
+    }
+
+    void CameraAravisNodelet::publishFrameSet(uint64_t set_id, std::vector<FrameSetAssembler::Member>& members) {
+        CA_TRACE_SCOPE("publish frame set");
+        FrameSetPtr set = boost::make_shared<FrameSet>();
+        set->header.stamp.fromNSec(members.front().timestamp_ns);
+        set->header.frame_id = members.front().frame.stream->frame_id;
+        set->set_id = set_id;
+        for (FrameSetAssembler::Member& member : members) {
+            FrameSetMember& frame = member.frame;
+            ros::Time own_stamp;
+            own_stamp.fromNSec(member.timestamp_ns);
+            set->frame_ids.push_back(frame.stream->frame_id);
+            set->stamps.push_back(own_stamp);
+            set->camera_frame_ids.push_back(member.frame_id);
+            set->published.push_back(static_cast<bool>(frame.image));
+
+            if (frame.image) { publishImage(*frame.stream, frame.image, frame.camera_info); }
+        }
+
+        // once on each camera of the set
+        for (size_t i = 0; i < members.size(); ++i) {
+            const ros::Publisher& publisher = members[i].frame.stream->frame_set_publisher;
+            bool published = false;
+            for (size_t j = 0; j < i; ++j) { published |= members[j].frame.stream->frame_set_publisher == publisher; }
+            if (!published && publisher.getNumSubscribers() > 0) { publisher.publish(set); }
+        }
+    }
+
+    std::shared_ptr<CameraAravisNodelet::FrameSetAssembler>
+    CameraAravisNodelet::sharedFrameSetAssembler(const std::string& group, const FrameSetAssembler::Config& config) {
+        static std::mutex mutex;
+        static std::map<std::string, std::weak_ptr<FrameSetAssembler>> groups;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<FrameSetAssembler> res = groups[group].lock();
+        if (res) {
+            ROS_INFO("Joining frame set group '%s', configured by its first camera", group.c_str());
+        } else {
+            res = std::make_shared<FrameSetAssembler>(config);
+            groups[group] = res;
+        }
+        return res;
+    }
+
+    void CameraAravisNodelet::latchTimestamp() {
+        // the camera latches within the round trip of the command, so its midpoint is accurate to half the round
+        // trip; the fastest of a few is the best sample
+        static constexpr int N_LATCHES = 5;
+
+        guint64 best_round_trip = std::numeric_limits<guint64>::max(), best_host = 0;
+        gint64 best_value = 0;
+        for (int i = 0; i < N_LATCHES; ++i) {
+            const guint64 t_begin = host_time_ns();
+            executeCommand(latch_command_.c_str());
+            const guint64 t_end = host_time_ns();
+            const gint64 value = aravis::device::feature::get_integer(device, latch_value_.c_str());
+
+            if (t_end >= t_begin && t_end - t_begin < best_round_trip && value > 0) {
+                best_round_trip = t_end - t_begin;
+                best_host = t_begin + (t_end - t_begin) / 2;
+                best_value = value;
+            }
+        }
+        if (best_host == 0) { return; }
+
+        const guint64 f = latch_tick_frequency_;
+        const guint64 camera_ns = (best_value / f) * 1000000000ull + (best_value % f) * 1000000000ull / f;
+        latched_clock_->update(camera_ns, best_host);
+        latch_round_trip_ns_ = best_round_trip;
+    }
+
+    bool CameraAravisNodelet::isImplemented(const std::string& feature) const {
+        // discover_features lists every feature of the description, with whether it is usable
+        auto it = implemented_features_.find(feature);
+        return it != implemented_features_.end() && it->second;
+    }
+
+    void CameraAravisNodelet::executeCommand(const char* cmd) {
+        if (feature_cache_) {
+            feature_cache_->execute_command(cmd);
+        } else {
+            aravis::device::execute_command(device, cmd);
+        }
+    }
+
+    void CameraAravisNodelet::selectStreamChannel(int stream_id) {
+        aravis::camera::gv::select_stream_channel(camera, stream_id);
+        // the cached GevSC* values are those of the previous channel
+        feature_cache_->invalidate("GevStreamChannelSelector");
+    }
+
+    void CameraAravisNodelet::setMulticastDestination(int stream_id) {
+        in_addr group{};
+        if (inet_pton(AF_INET, multicast_address_.c_str(), &group) != 1 || !IN_MULTICAST(ntohl(group.s_addr))) {
+            ROS_ERROR("Stream %i: invalid multicast address '%s', keeping unicast", stream_id,
+                      multicast_address_.c_str());
+            return;
+        }
+
+        // creating the stream pointed the channel at the socket of aravis, redirect it to the group
+        const int port = multicast_port_ + stream_id;
+        control(internal::ControlExecutor::ACQUISITION, [&]() {
+            selectStreamChannel(stream_id);
+            feature_cache_->set_integer("GevSCDA", ntohl(group.s_addr));
+            feature_cache_->set_integer("GevSCPHostPort", port);
+        });
+        ROS_INFO("Stream %i: sending to multicast group %s:%i, received by CameraAravisListenerNodelet", stream_id,
+                 multicast_address_.c_str(), port);
+    }
+
+    void CameraAravisNodelet::scheduleBandwidth(int stream_id, gint packet_size, gint64 n_bytes_payload) {
+        internal::BandwidthScheduler::Member member;
+        member.shared_link_bps = bandwidth_link_speed_;
+        member.utilization = bandwidth_utilization_;
+        member.packet_size = packet_size;
+        member.packets_per_frame = internal::packetsPerFrame(packet_size, n_bytes_payload);
+        control(internal::ControlExecutor::ACQUISITION, [&]() {
+            member.group = aravis::device::GigEVision::get_interface_address(device);
+            // DeviceLinkSpeed is in byte/s (SFNC), the older GevLinkSpeed in Mbit/s
+            if (isImplemented("DeviceLinkSpeed")) {
+                member.link_speed_bps = aravis::device::feature::get_integer(device, "DeviceLinkSpeed") * 8.0;
+            } else if (isImplemented("GevLinkSpeed")) {
+                member.link_speed_bps = aravis::device::feature::get_integer(device, "GevLinkSpeed") * 1e6;
+            }
+            if (isImplemented("AcquisitionFrameRate")) {
+                member.frame_rate = feature_cache_->read_float("AcquisitionFrameRate");
+            }
+            if (isImplemented("GevTimestampTickFrequency")) {
+                const gint64 tick_frequency = aravis::device::feature::get_integer(device, "GevTimestampTickFrequency");
+                if (tick_frequency > 0) { member.tick_frequency = tick_frequency; }
+            }
+        });
+
+        if (!isImplemented("GevSCPD")) {
+            ROS_WARN("Stream %i: camera has no GevSCPD, not taking part in bandwidth scheduling", stream_id);
+            return;
+        }
+
+        // runs on the thread of whichever camera joined or left, so only post the feature writes
+        member.apply = [this, stream_id](const internal::BandwidthScheduler::Allocation& allocation) {
+            if (!control_executor_) { return; }
+            auto write_delays = [this, stream_id, allocation]() {
+                selectStreamChannel(stream_id);
+                feature_cache_->set_integer("GevSCPD", allocation.packet_delay_ticks);
+                if (isImplemented("GevSCFTD")) {
+                    feature_cache_->set_integer("GevSCFTD", allocation.frame_delay_ticks);
+                }
+                ROS_INFO("Stream %i: %.0f of %.0f Mbit/s needed, %.0f allocated, packet delay %.1f us, frame delay "
+                         "%.1f us",
+                         stream_id, allocation.required_bps * 1e-6, allocation.budget_bps * 1e-6,
+                         allocation.allocated_bps * 1e-6, allocation.packet_delay_s * 1e6,
+                         allocation.frame_delay_s * 1e6);
+            };
+            control_executor_->post(internal::ControlExecutor::ACQUISITION, write_delays);
+        };
+
+        bandwidth_members_.push_back(internal::BandwidthScheduler::instance().add(member));
+    }
+
+    void CameraAravisNodelet::updateStreamStatistics() {
+        double configured_frame_rate = 0.0;
+        if (isImplemented("AcquisitionFrameRate")) {
+            configured_frame_rate = control(internal::ControlExecutor::DIAGNOSTICS,
+                                            [&]() { return feature_cache_->read_float("AcquisitionFrameRate"); });
+        }
+        // bytes/s
+        double link_speed = 0.0;
+        if (isImplemented("DeviceLinkSpeed")) {
+            link_speed = control(internal::ControlExecutor::DIAGNOSTICS,
+                                 [&]() { return feature_cache_->read_integer("DeviceLinkSpeed"); });
+        }
+
+        const ros::Time now = ros::Time::now();
+        for (Stream& stream : streams_) {
+            if (!stream.arv_stream) { continue; }
+
+            guint64 n_completed = 0, n_failures = 0, n_underruns = 0, n_resent = 0, n_missing = 0;
+            arv_stream_get_statistics(stream.arv_stream.get(), &n_completed, &n_failures, &n_underruns);
+            if (aravis::device::is_gv(device)) {
+                arv_gv_stream_get_statistics(reinterpret_cast<ArvGvStream*>(stream.arv_stream.get()), &n_resent,
+                                             &n_missing);
+            }
+
+            internal::StreamMonitor::Counters counters;
+            counters.n_completed = n_completed;
+            counters.n_failures = n_failures;
+            counters.n_underruns = n_underruns;
+            counters.n_resent = n_resent;
+            counters.n_missing = n_missing;
+            const internal::StreamMonitor::Window window = stream.monitor->collect(counters);
+
+            if (stream.gv_tuner) {
+                internal::GvStreamTuner::Observation observation;
+                observation.n_frames = window.n_frames;
+                observation.n_resent = window.delta.n_resent;
+                observation.n_missing = window.delta.n_missing;
+                observation.n_failures = window.delta.n_failures;
+                observation.interval_mean_s = window.interval_mean_s;
+                if (stream.gv_tuner->update(observation)) {
+                    const internal::GvStreamOptions& options = stream.gv_tuner->options();
+                    internal::tuneGvStream(reinterpret_cast<ArvGvStream*>(stream.arv_stream.get()), options);
+                    stream.gv_options = options;
+                    ROS_INFO("Stream %s: socket buffer %u bytes, packet timeout %u ms, frame retention %u ms",
+                             stream.name.c_str(), options.socket_buffer_size, options.packet_timeout_ms,
+                             options.frame_retention_ms);
+                }
+            }
+
+            StreamStatistics msg;
+            msg.header.stamp = now;
+            msg.header.frame_id = frame_id_;
+            msg.stream = stream.name;
+            msg.window = window.duration_s;
+            msg.frame_rate = window.frame_rate();
+            msg.configured_frame_rate = configured_frame_rate;
+            msg.throughput = window.bytes_rate() * 1e-6;
+            if (link_speed > 0.0) { msg.link_utilization = window.bytes_rate() / link_speed; }
+            msg.interval_mean = window.interval_mean_s * 1e3;
+            msg.interval_jitter = window.interval_stddev_s * 1e3;
+            msg.interval_max = window.interval_max_s * 1e3;
+            if (window.duration_s > 0.0) {
+                msg.resent_packets_rate = window.delta.n_resent / window.duration_s;
+                msg.missing_packets_rate = window.delta.n_missing / window.duration_s;
+            }
+            if (aravis::device::is_gv(device)) {
+                const internal::GvStreamOptions& options = stream.gv_options;
+                msg.socket_buffer_size = options.auto_socket_buffer ? 0 : options.socket_buffer_size;
+                msg.packet_timeout = options.packet_timeout_ms;
+                msg.frame_retention = options.frame_retention_ms;
+            }
+            msg.failures = window.delta.n_failures;
+            msg.underruns = window.delta.n_underruns;
+            msg.cpu_pop = window.cpu_ms_per_frame(internal::StreamMonitor::CPU_POP);
+            msg.cpu_conversion = window.cpu_ms_per_frame(internal::StreamMonitor::CPU_CONVERSION);
+            msg.cpu_camera_info = window.cpu_ms_per_frame(internal::StreamMonitor::CPU_CAMERA_INFO);
+            msg.cpu_publish = window.cpu_ms_per_frame(internal::StreamMonitor::CPU_PUBLISH);
+            if (window.n_cpu_frames > 0) { msg.cpu_per_frame = window.cpu_total_ns() * 1e-6 / window.n_cpu_frames; }
+            if (window.duration_s > 0.0) { msg.cpu_load = window.cpu_total_ns() * 1e-6 / window.duration_s; }
+            if (stream.buffer_pool) {
+                msg.pool_used = stream.buffer_pool->getUsedSize();
+                msg.pool_allocated = stream.buffer_pool->getAllocatedSize();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(stream_statistics_mutex_);
+                stream.last_statistics = msg;
+            }
+
+            if (stream.statistics_publisher.getNumSubscribers() > 0) { stream.statistics_publisher.publish(msg); }
+        }
     }
 
     void CameraAravisNodelet::controlLostCallback(ArvDevice* p_gv_device, gpointer can_instance) {
         auto* p_can = static_cast<CameraAravisNodelet*>(can_instance);
         ROS_ERROR("Control to aravis device (%s) lost.", p_can->guid_.c_str());
+        p_can->control_lost_ = true;
         p_can->shutdown();
     }
 
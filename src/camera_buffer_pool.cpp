@@ -23,47 +23,156 @@
 
 #include <camera_aravis/camera_buffer_pool.h>
 
+#include <cstring>
+
+#include <camera_aravis_internal/hotpath_checks.h>
+#include <camera_aravis_internal/trace.h>
+
 namespace camera_aravis {
 
+    namespace internal {
+        // Memory for the control blocks of the shared pointers handed out by the pool. Every image is wrapped with a
+        // deleter when it is handed out, so boost::shared_ptr allocates a control block each time; blocks returned
+        // here are reused instead. New blocks are only allocated while more images are in use than ever before.
+        class ControlBlockArena {
+            public:
+            ~ControlBlockArena() {
+                for (void* block : free_blocks_) { ::operator delete(block); }
+            }
+
+            void* allocate(size_t size) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (block_size_ == 0) { block_size_ = size; }
+                    if (size == block_size_) {
+                        if (!free_blocks_.empty()) {
+                            void* block = free_blocks_.back();
+                            free_blocks_.pop_back();
+                            return block;
+                        }
+                        // room to return every block without allocating
+                        free_blocks_.reserve(++n_blocks_);
+                    }
+                }
+                return ::operator new(size);
+            }
+
+            void deallocate(void* block, size_t size) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (size == block_size_) {
+                        free_blocks_.push_back(block);
+                        return;
+                    }
+                }
+                ::operator delete(block);
+            }
+
+            private:
+            std::mutex mutex_;
+            size_t block_size_ = 0;
+            size_t n_blocks_ = 0;
+            std::vector<void*> free_blocks_;
+        };
+
+        namespace {
+            template<typename T>
+            class ControlBlockAllocator {
+                public:
+                typedef T value_type;
+
+                template<typename U>
+                struct rebind {
+                    typedef ControlBlockAllocator<U> other;
+                };
+
+                explicit ControlBlockAllocator(const std::shared_ptr<ControlBlockArena>& arena): arena_(arena) {}
+
+                template<typename U>
+                ControlBlockAllocator(const ControlBlockAllocator<U>& other): arena_(other.arena()) {}
+
+                T* allocate(size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T))); }
+
+                void deallocate(T* p, size_t n) { arena_->deallocate(p, n * sizeof(T)); }
+
+                const std::shared_ptr<ControlBlockArena>& arena() const { return arena_; }
+
+                template<typename U>
+                bool operator==(const ControlBlockAllocator<U>& other) const {
+                    return arena_ == other.arena();
+                }
+
+                template<typename U>
+                bool operator!=(const ControlBlockAllocator<U>& other) const {
+                    return arena_ != other.arena();
+                }
+
+                private:
+                // control blocks still in use keep the arena alive after the pool is gone
+                std::shared_ptr<ControlBlockArena> arena_;
+            };
+        }  // namespace
+    }  // namespace internal
+
     CameraBufferPool::CameraBufferPool(ArvStream* stream, size_t payload_size_bytes, size_t n_preallocated_buffers):
         stream_(stream),
         payload_size_bytes_(payload_size_bytes),
         n_buffers_(0),
+        arena_(std::make_shared<internal::ControlBlockArena>()),
         self_(this, [](CameraBufferPool* p) {}) {
         allocateBuffers(n_preallocated_buffers);
     }
 
-    CameraBufferPool::~CameraBufferPool() {}
+    CameraBufferPool::~CameraBufferPool() {
+        // images in use are deleted by reclaim() once released
+        for (const std::unique_ptr<Slot>& slot : slots_) {
+            if (!slot->in_use) { delete slot->image; }
+        }
+        for (sensor_msgs::Image* p_img : dangling_imgs_) { delete p_img; }
+    }
+
+    sensor_msgs::ImagePtr CameraBufferPool::wrap(Slot* slot, sensor_msgs::Image* p_img) {
+        return sensor_msgs::ImagePtr(
+            p_img, boost::bind(&CameraBufferPool::reclaim, this->weak_from_this(), slot, boost::placeholders::_1),
+            internal::ControlBlockAllocator<sensor_msgs::Image>(arena_));
+    }
 
     sensor_msgs::ImagePtr CameraBufferPool::getRecyclableImg() {
-        std::lock_guard<std::mutex> lock(mutex_);
+        CA_HOTPATH_LOCK_GUARD(lock, mutex_);
+        sensor_msgs::Image* p_img = nullptr;
         if (dangling_imgs_.empty()) {
-            return sensor_msgs::ImagePtr(
-                new sensor_msgs::Image,
-                boost::bind(&CameraBufferPool::reclaim, this->weak_from_this(), boost::placeholders::_1));
+            CA_TRACE_INSTANT("allocate image");
+            p_img = new sensor_msgs::Image;
+            // room to take back every recyclable image without allocating
+            dangling_imgs_.reserve(++n_recyclable_imgs_);
         } else {
-            sensor_msgs::ImagePtr img_ptr = dangling_imgs_.top();
-            dangling_imgs_.pop();
-            return img_ptr;
+            p_img = dangling_imgs_.back();
+            dangling_imgs_.pop_back();
         }
+        return wrap(nullptr, p_img);
     }
 
     sensor_msgs::ImagePtr CameraBufferPool::operator[](ArvBuffer* buffer) {
-        std::lock_guard<std::mutex> lock(mutex_);
+        CA_HOTPATH_SCOPE("CameraBufferPool::operator[]");
+        CA_HOTPATH_LOCK_GUARD(lock, mutex_);
         sensor_msgs::ImagePtr img_ptr;
         if (buffer) {
             // get address and size
             size_t buffer_size;
             const uint8_t* buffer_data = (const uint8_t*) arv_buffer_get_data(buffer, &buffer_size);
 
-            // find corresponding ImagePtr wrapper
-            std::map<const uint8_t*, sensor_msgs::ImagePtr>::iterator iter = available_img_buffers_.find(buffer_data);
-            if (iter != available_img_buffers_.end()) {
-                img_ptr = iter->second;
-                used_buffers_.emplace(img_ptr.get(), buffer);
-                available_img_buffers_.erase(iter);
+            // find corresponding image wrapper
+            auto iter = slots_by_data_.find(buffer_data);
+            if (iter != slots_by_data_.end() && !iter->second->in_use) {
+                Slot* slot = iter->second;
+                slot->buffer = buffer;
+                slot->in_use = true;
+                ++n_used_;
+                img_ptr = wrap(slot, slot->image);
+                CA_TRACE_COUNTER("pool used", n_used_);
             } else {
                 ROS_WARN("Could not find available image in pool corresponding to buffer.");
+                CA_TRACE_SCOPE("copy buffer");
                 img_ptr.reset(new sensor_msgs::Image);
                 img_ptr->data.resize(buffer_size);
                 memcpy(img_ptr->data.data(), buffer_data, buffer_size);
@@ -74,21 +183,21 @@ namespace camera_aravis {
     }
 
     void CameraBufferPool::allocateBuffers(size_t n) {
+        if (n == 0) { return; }
+
+        CA_TRACE_SCOPE("allocate buffers");
         std::lock_guard<std::mutex> lock(mutex_);
 
         if (ARV_IS_STREAM(stream_)) {
             for (size_t i = 0; i < n; ++i) {
-                sensor_msgs::Image* p_img = new sensor_msgs::Image;
-
-                p_img->data.resize(payload_size_bytes_);
-
-                ArvBuffer* buffer = arv_buffer_new(payload_size_bytes_, p_img->data.data());
-                sensor_msgs::ImagePtr img_ptr(
-                    p_img, boost::bind(&CameraBufferPool::reclaim, this->weak_from_this(), boost::placeholders::_1));
-
-                available_img_buffers_.emplace(p_img->data.data(), img_ptr);
-
-                arv_stream_push_buffer(stream_, buffer);
+                std::unique_ptr<Slot> slot = std::make_unique<Slot>();
+                slot->image = new sensor_msgs::Image;
+                slot->image->data.resize(payload_size_bytes_);
+                slot->buffer = arv_buffer_new(payload_size_bytes_, slot->image->data.data());
+
+                slots_by_data_.emplace(slot->image->data.data(), slot.get());
+                arv_stream_push_buffer(stream_, slot->buffer);
+                slots_.push_back(std::move(slot));
                 ++n_buffers_;
             }
             ROS_INFO_STREAM("Allocated " << n << " image buffers of size " << payload_size_bytes_);
@@ -97,35 +206,34 @@ namespace camera_aravis {
         }
     }
 
-    void CameraBufferPool::reclaim(const WPtr& self, sensor_msgs::Image* p_img) {
+    void CameraBufferPool::reclaim(const WPtr& self, Slot* slot, sensor_msgs::Image* p_img) {
         Ptr s = self.lock();
         if (s) {
-            s->push(p_img);
+            s->push(slot, p_img);
         } else {
             delete p_img;
         }
     }
 
-    void CameraBufferPool::push(sensor_msgs::Image* p_img) {
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        std::map<sensor_msgs::Image*, ArvBuffer*>::iterator iter = used_buffers_.find(p_img);
+    void CameraBufferPool::push(Slot* slot, sensor_msgs::Image* p_img) {
+        CA_HOTPATH_SCOPE("CameraBufferPool::push");
+        CA_HOTPATH_LOCK_GUARD(lock, mutex_);
 
-        if (iter != used_buffers_.end()) {
+        if (slot) {
+            slot->in_use = false;
+            --n_used_;
             if (ARV_IS_STREAM(stream_)) {
-                sensor_msgs::ImagePtr img_ptr(
-                    p_img, boost::bind(&CameraBufferPool::reclaim, this->weak_from_this(), boost::placeholders::_1));
-                available_img_buffers_.emplace(p_img->data.data(), img_ptr);
-                arv_stream_push_buffer(stream_, iter->second);
+                arv_stream_push_buffer(stream_, slot->buffer);
             } else {
                 // the camera stream is gone, so should its buffers
+                slots_by_data_.erase(p_img->data.data());
+                slot->image = nullptr;
                 delete p_img;
             }
-            used_buffers_.erase(iter);
+            CA_TRACE_COUNTER("pool used", n_used_);
         } else {
             // this image was not an aravis registered buffer
-            dangling_imgs_.emplace(
-                p_img, boost::bind(&CameraBufferPool::reclaim, this->weak_from_this(), boost::placeholders::_1));
+            dangling_imgs_.push_back(p_img);
         }
     }
 
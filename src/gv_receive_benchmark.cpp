@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ * camera_aravis
+ *
+ * Copyright © 2022 Fraunhofer IOSB and contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+
+// Benchmark of the GigE Vision receive paths against a camera on loopback, usually the aravis fake camera.
+//
+// Receives the same stream once through a packet socket and once through UDP sockets, and prints the CPU time
+// this process spends per frame in each (the aravis stream thread receives and reassembles the packets; this
+// thread only pops and returns the buffers). See fake_camera_benchmark.launch.
+//
+//   guid      camera, Aravis-Fake-GV01 for arv-fake-gv-camera-0.8
+//   width, height, fps
+//   frames    frames measured per receive path, after warmup_frames
+
+#include <algorithm>
+#include <ctime>
+#include <string>
+
+#include <ros/ros.h>
+
+#include <camera_aravis_internal/tuneGVStream.h>
+
+extern "C" {
+#include <arv.h>
+}
+
+namespace {
+
+    double process_cpu_s() {
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    struct Result {
+        int n_frames = 0;
+        guint64 n_failures = 0;
+        double wall_s = 0.0;
+        double cpu_s = 0.0;
+    };
+
+    bool receive(ArvCamera* camera, ArvGvStreamOption option, int n_warmup, int n_frames, int n_buffers,
+                 Result& result) {
+        GError* error = nullptr;
+        arv_gv_device_set_stream_options(ARV_GV_DEVICE(arv_camera_get_device(camera)), option);
+        ArvStream* stream = arv_camera_create_stream(camera, nullptr, nullptr, &error);
+        if (!stream) {
+            ROS_ERROR("Cannot create the stream: %s", error ? error->message : "unknown error");
+            g_clear_error(&error);
+            return false;
+        }
+
+        const gint payload = arv_camera_get_payload(camera, nullptr);
+        for (int i = 0; i < n_buffers; ++i) { arv_stream_push_buffer(stream, arv_buffer_new(payload, nullptr)); }
+
+        arv_camera_start_acquisition(camera, &error);
+        if (error) {
+            ROS_ERROR("Cannot start the acquisition: %s", error->message);
+            g_clear_error(&error);
+            g_object_unref(stream);
+            return false;
+        }
+
+        guint64 n_failures_begin = 0;
+        double begin_wall = 0.0;
+        double begin_cpu = 0.0;
+        int n_received = 0;
+        while (ros::ok() && n_received < n_warmup + n_frames) {
+            ArvBuffer* buffer = arv_stream_timeout_pop_buffer(stream, 2000000);
+            if (!buffer) {
+                ROS_ERROR("No frame within 2 s");
+                break;
+            }
+            if (arv_buffer_get_status(buffer) == ARV_BUFFER_STATUS_SUCCESS && ++n_received == n_warmup) {
+                arv_stream_get_statistics(stream, nullptr, &n_failures_begin, nullptr);
+                begin_wall = ros::WallTime::now().toSec();
+                begin_cpu = process_cpu_s();
+            }
+            arv_stream_push_buffer(stream, buffer);
+        }
+
+        result.n_frames = n_received - n_warmup;
+        result.wall_s = ros::WallTime::now().toSec() - begin_wall;
+        result.cpu_s = process_cpu_s() - begin_cpu;
+        arv_stream_get_statistics(stream, nullptr, &result.n_failures, nullptr);
+        result.n_failures -= n_failures_begin;
+
+        arv_camera_stop_acquisition(camera, nullptr);
+        g_object_unref(stream);
+        return result.n_frames > 0;
+    }
+
+    void print(const char* path, const Result& result) {
+        ROS_INFO("%-14s %6d frames, %4lu failed, %6.1f Hz, CPU %8.1f us/frame, %5.1f %%", path, result.n_frames,
+                 static_cast<unsigned long>(result.n_failures), result.n_frames / result.wall_s,
+                 result.cpu_s / result.n_frames * 1e6, result.cpu_s / result.wall_s * 1e2);
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    ros::init(argc, argv, "gv_receive_benchmark");
+    ros::NodeHandle pnh("~");
+
+    const std::string guid = pnh.param<std::string>("guid", "Aravis-Fake-GV01");
+    const int width = pnh.param<int>("width", 1920);
+    const int height = pnh.param<int>("height", 1080);
+    const double fps = pnh.param<double>("fps", 100.0);
+    const int n_frames = pnh.param<int>("frames", 1000);
+    const int n_warmup = std::max(1, pnh.param<int>("warmup_frames", 50));
+    const int n_buffers = pnh.param<int>("buffers", 20);
+
+    GError* error = nullptr;
+    ArvCamera* camera = arv_camera_new(guid.c_str(), &error);
+    if (!camera) {
+        ROS_FATAL("Cannot open %s: %s", guid.c_str(), error ? error->message : "unknown error");
+        g_clear_error(&error);
+        return 1;
+    }
+    if (!arv_camera_is_gv_device(camera)) {
+        ROS_FATAL("%s is no GigE Vision camera", guid.c_str());
+        g_object_unref(camera);
+        return 1;
+    }
+
+    arv_camera_set_region(camera, 0, 0, width, height, nullptr);
+    arv_camera_set_acquisition_mode(camera, ARV_ACQUISITION_MODE_CONTINUOUS, nullptr);
+    arv_camera_set_frame_rate(camera, fps, nullptr);
+    ROS_INFO("Receiving %d frames of %dx%d at %.1f Hz from %s through each path", n_frames, width, height, fps,
+             guid.c_str());
+
+    // aravis silently falls back to UDP sockets without CAP_NET_RAW, which would measure UDP twice
+    const bool packet_socket_available = camera_aravis::internal::packetSocketAvailable();
+    if (!packet_socket_available) { ROS_WARN("Packet socket not permitted (needs CAP_NET_RAW), skipping it"); }
+    Result packet_socket;
+    const bool packet_socket_ok = packet_socket_available && receive(camera, ARV_GV_STREAM_OPTION_NONE, n_warmup,
+                                                                     n_frames, n_buffers, packet_socket);
+    Result udp;
+    const bool udp_ok = receive(camera, ARV_GV_STREAM_OPTION_PACKET_SOCKET_DISABLED, n_warmup, n_frames, n_buffers,
+                                udp);
+
+    if (packet_socket_ok) { print("packet socket:", packet_socket); }
+    if (udp_ok) { print("UDP sockets:", udp); }
+    if (packet_socket_ok && udp_ok) {
+        ROS_INFO("packet socket uses %.0f %% of the CPU time per frame of UDP sockets",
+                 (packet_socket.cpu_s / packet_socket.n_frames) / (udp.cpu_s / udp.n_frames) * 1e2);
+    }
+
+    g_object_unref(camera);
+    return packet_socket_ok || udp_ok ? 0 : 1;
+}
@@ -2,80 +2,225 @@
 
 #include <camera_aravis_internal/GErrorGuard.h>
 
+#include <string>
 
 namespace camera_aravis {
     namespace aravis {
         namespace device {
             void execute_command(const NonOwnedGPtr<ArvDevice>& dev, const char* cmd) {
-                GuardedGError err;
-                arv_device_execute_command(dev.get(), cmd, err.storeError());
-                LOG_GERROR_ARAVIS(err);
+                feature::Command(dev, cmd).execute();
             }
 
             namespace feature {
-                gboolean get_boolean(const NonOwnedGPtr<ArvDevice>& dev, const char* feat) {
+                ArvGcNode* get_node(const NonOwnedGPtr<ArvDevice>& dev, const char* feat) {
+                    if (!dev || !feat) return nullptr;
+                    return arv_device_get_feature(dev.get(), feat);
+                }
+
+                Node::Node(const NonOwnedGPtr<ArvDevice>& dev, const char* feat): Node(get_node(dev, feat), feat) {}
+
+                Node::Node(ArvGcNode* node, const char* feat): node_(node), name_(feat ? feat : "") {
+                    // keep a name which lives as long as the node itself
+                    if (node_ && ARV_IS_GC_FEATURE_NODE(node_)) {
+                        name_ = arv_gc_feature_node_get_name(ARV_GC_FEATURE_NODE(node_));
+                    }
+                }
+
+                bool Node::check(bool type_matches, const char* type_name, GuardedGError& err) const {
+                    if (!node_) {
+                        g_set_error(err.storeError(), ARV_DEVICE_ERROR, ARV_DEVICE_ERROR_FEATURE_NOT_FOUND,
+                                    "[%s] Not found", name_);
+                        return false;
+                    }
+                    if (!type_matches) {
+                        g_set_error(err.storeError(), ARV_DEVICE_ERROR, ARV_DEVICE_ERROR_WRONG_FEATURE,
+                                    "[%s] Not a %s", name_, type_name);
+                        return false;
+                    }
+                    return true;
+                }
+
+                gboolean Boolean::get() const {
                     GuardedGError err;
-                    gboolean res = arv_device_get_boolean_feature_value(dev.get(), feat, err.storeError());
+                    gboolean res = get(err);
                     LOG_GERROR_ARAVIS(err);
                     return res;
                 }
 
-                void set_boolean(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, gboolean val) {
+                gboolean Boolean::get(GuardedGError& err) const {
+                    if (!check(ARV_IS_GC_BOOLEAN(node_) || ARV_IS_GC_INTEGER(node_), "boolean", err)) return FALSE;
+                    if (ARV_IS_GC_BOOLEAN(node_)) {
+                        return arv_gc_boolean_get_value(ARV_GC_BOOLEAN(node_), err.storeError());
+                    }
+                    return arv_gc_integer_get_value(ARV_GC_INTEGER(node_), err.storeError()) != 0;
+                }
+
+                void Boolean::set(gboolean val) const {
                     GuardedGError err;
-                    arv_device_set_boolean_feature_value(dev.get(), feat, val, err.storeError());
+                    set(val, err);
                     LOG_GERROR_ARAVIS(err);
                 }
 
-                gint64 get_integer(const NonOwnedGPtr<ArvDevice>& dev, const char* feat) {
+                void Boolean::set(gboolean val, GuardedGError& err) const {
+                    if (!check(ARV_IS_GC_BOOLEAN(node_) || ARV_IS_GC_INTEGER(node_), "boolean", err)) return;
+                    if (ARV_IS_GC_BOOLEAN(node_)) {
+                        arv_gc_boolean_set_value(ARV_GC_BOOLEAN(node_), val, err.storeError());
+                    } else {
+                        arv_gc_integer_set_value(ARV_GC_INTEGER(node_), val ? 1 : 0, err.storeError());
+                    }
+                }
+
+                gint64 Integer::get() const {
                     GuardedGError err;
-                    gint64 res = arv_device_get_integer_feature_value(dev.get(), feat, err.storeError());
+                    gint64 res = get(err);
                     LOG_GERROR_ARAVIS(err);
                     return res;
                 }
 
-                void set_integer(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, gint64 val) {
+                gint64 Integer::get(GuardedGError& err) const {
+                    if (!check(ARV_IS_GC_ENUMERATION(node_) || ARV_IS_GC_INTEGER(node_), "integer", err)) return 0;
+                    if (ARV_IS_GC_ENUMERATION(node_)) {
+                        return arv_gc_enumeration_get_int_value(ARV_GC_ENUMERATION(node_), err.storeError());
+                    }
+                    return arv_gc_integer_get_value(ARV_GC_INTEGER(node_), err.storeError());
+                }
+
+                void Integer::set(gint64 val) const {
                     GuardedGError err;
-                    arv_device_set_integer_feature_value(dev.get(), feat, val, err.storeError());
+                    set(val, err);
                     LOG_GERROR_ARAVIS(err);
                 }
 
-                double get_float(const NonOwnedGPtr<ArvDevice>& dev, const char* feat) {
+                void Integer::set(gint64 val, GuardedGError& err) const {
+                    if (!check(ARV_IS_GC_ENUMERATION(node_) || ARV_IS_GC_INTEGER(node_), "integer", err)) return;
+                    if (ARV_IS_GC_ENUMERATION(node_)) {
+                        arv_gc_enumeration_set_int_value(ARV_GC_ENUMERATION(node_), val, err.storeError());
+                    } else {
+                        arv_gc_integer_set_value(ARV_GC_INTEGER(node_), val, err.storeError());
+                    }
+                }
+
+                void Integer::get_bounds(gint64* min, gint64* max) const {
                     GuardedGError err;
-                    double res = arv_device_get_float_feature_value(dev.get(), feat, err.storeError());
+                    if (check(ARV_IS_GC_INTEGER(node_), "integer", err)) {
+                        if (min && !err) *min = arv_gc_integer_get_min(ARV_GC_INTEGER(node_), err.storeError());
+                        if (max && !err) *max = arv_gc_integer_get_max(ARV_GC_INTEGER(node_), err.storeError());
+                    }
+                    LOG_GERROR_ARAVIS(err);
+                }
+
+                double Float::get() const {
+                    GuardedGError err;
+                    double res = get(err);
                     LOG_GERROR_ARAVIS(err);
                     return res;
                 }
 
-                void set_float(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, double val) {
+                double Float::get(GuardedGError& err) const {
+                    if (!check(ARV_IS_GC_FLOAT(node_), "float", err)) return 0.0;
+                    return arv_gc_float_get_value(ARV_GC_FLOAT(node_), err.storeError());
+                }
+
+                void Float::set(double val) const {
                     GuardedGError err;
-                    arv_device_set_float_feature_value(dev.get(), feat, val, err.storeError());
+                    set(val, err);
                     LOG_GERROR_ARAVIS(err);
                 }
 
-                const char* get_string(const NonOwnedGPtr<ArvDevice>& dev, const char* feat) {
+                void Float::set(double val, GuardedGError& err) const {
+                    if (!check(ARV_IS_GC_FLOAT(node_), "float", err)) return;
+                    arv_gc_float_set_value(ARV_GC_FLOAT(node_), val, err.storeError());
+                }
+
+                void Float::get_bounds(double* min, double* max) const {
                     GuardedGError err;
-                    const char* res = arv_device_get_string_feature_value(dev.get(), feat, err.storeError());
+                    if (check(ARV_IS_GC_FLOAT(node_), "float", err)) {
+                        if (min && !err) *min = arv_gc_float_get_min(ARV_GC_FLOAT(node_), err.storeError());
+                        if (max && !err) *max = arv_gc_float_get_max(ARV_GC_FLOAT(node_), err.storeError());
+                    }
+                    LOG_GERROR_ARAVIS(err);
+                }
+
+                const char* String::get() const {
+                    GuardedGError err;
+                    const char* res = get(err);
                     LOG_GERROR_ARAVIS(err);
                     return res;
                 }
 
-                void set_string(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, const char* val) {
+                const char* String::get(GuardedGError& err) const {
+                    if (!check(ARV_IS_GC_ENUMERATION(node_) || ARV_IS_GC_STRING(node_), "string", err)) return nullptr;
+                    if (ARV_IS_GC_ENUMERATION(node_)) {
+                        return arv_gc_enumeration_get_string_value(ARV_GC_ENUMERATION(node_), err.storeError());
+                    }
+                    return arv_gc_string_get_value(ARV_GC_STRING(node_), err.storeError());
+                }
+
+                void String::set(const char* val) const {
                     GuardedGError err;
-                    arv_device_set_string_feature_value(dev.get(), feat, val, err.storeError());
+                    set(val, err);
                     LOG_GERROR_ARAVIS(err);
                 }
 
+                void String::set(const char* val, GuardedGError& err) const {
+                    if (!check(ARV_IS_GC_ENUMERATION(node_) || ARV_IS_GC_STRING(node_), "string", err)) return;
+                    if (ARV_IS_GC_ENUMERATION(node_)) {
+                        arv_gc_enumeration_set_string_value(ARV_GC_ENUMERATION(node_), val, err.storeError());
+                    } else {
+                        arv_gc_string_set_value(ARV_GC_STRING(node_), val, err.storeError());
+                    }
+                }
+
+                void Command::execute() const {
+                    GuardedGError err;
+                    execute(err);
+                    LOG_GERROR_ARAVIS(err);
+                }
+
+                void Command::execute(GuardedGError& err) const {
+                    if (!check(ARV_IS_GC_COMMAND(node_), "command", err)) return;
+                    arv_gc_command_execute(ARV_GC_COMMAND(node_), err.storeError());
+                }
+
+                gboolean get_boolean(const NonOwnedGPtr<ArvDevice>& dev, const char* feat) {
+                    return Boolean(dev, feat).get();
+                }
+
+                void set_boolean(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, gboolean val) {
+                    Boolean(dev, feat).set(val);
+                }
+
+                gint64 get_integer(const NonOwnedGPtr<ArvDevice>& dev, const char* feat) {
+                    return Integer(dev, feat).get();
+                }
+
+                void set_integer(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, gint64 val) {
+                    Integer(dev, feat).set(val);
+                }
+
+                double get_float(const NonOwnedGPtr<ArvDevice>& dev, const char* feat) {
+                    return Float(dev, feat).get();
+                }
+
+                void set_float(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, double val) {
+                    Float(dev, feat).set(val);
+                }
+
+                const char* get_string(const NonOwnedGPtr<ArvDevice>& dev, const char* feat) {
+                    return String(dev, feat).get();
+                }
+
+                void set_string(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, const char* val) {
+                    String(dev, feat).set(val);
+                }
+
                 namespace bounds {
                     void get_integer(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, gint64* min, gint64* max) {
-                        GuardedGError err;
-                        arv_device_get_integer_feature_bounds(dev.get(), feat, min, max, err.storeError());
-                        LOG_GERROR_ARAVIS(err);
+                        Integer(dev, feat).get_bounds(min, max);
                     }
 
                     void get_float(const NonOwnedGPtr<ArvDevice>& dev, const char* feat, double* min, double* max) {
-                        GuardedGError err;
-                        arv_device_get_float_feature_bounds(dev.get(), feat, min, max, err.storeError());
-                        LOG_GERROR_ARAVIS(err);
+                        Float(dev, feat).get_bounds(min, max);
                     }
                 }  // namespace bounds
             }      // namespace feature
@@ -113,6 +258,25 @@ namespace camera_aravis {
 #endif
             }  // namespace USB3Vision
 
+            namespace GigEVision {
+                std::string get_interface_address(const NonOwnedGPtr<ArvDevice>& dev) {
+                    if (!is_gv(dev)) { return ""; }
+
+                    GSocketAddress* address = arv_gv_device_get_interface_address(ARV_GV_DEVICE(dev.get()));
+                    if (!address || !G_IS_INET_SOCKET_ADDRESS(address)) { return ""; }
+
+                    gchar* str =
+                        g_inet_address_to_string(g_inet_socket_address_get_address(G_INET_SOCKET_ADDRESS(address)));
+                    std::string res = str ? str : "";
+                    g_free(str);
+                    return res;
+                }
+
+                void set_stream_options(const NonOwnedGPtr<ArvDevice>& dev, ArvGvStreamOption options) {
+                    if (is_gv(dev)) { arv_gv_device_set_stream_options(ARV_GV_DEVICE(dev.get()), options); }
+                }
+            }  // namespace GigEVision
+
         }  // namespace device
 
         GPtr<ArvCamera> camera_new(const char* name) {
@@ -297,6 +461,26 @@ namespace camera_aravis {
                     arv_camera_gv_select_stream_channel(cam.get(), channel_id, err.storeError());
                     LOG_GERROR_ARAVIS(err);
                 }
+
+                gint get_packet_size(const NonOwnedGPtr<ArvCamera>& cam) {
+                    GuardedGError err;
+                    gint res = arv_camera_gv_get_packet_size(cam.get(), err.storeError());
+                    LOG_GERROR_ARAVIS(err);
+                    return res;
+                }
+
+                void set_packet_size(const NonOwnedGPtr<ArvCamera>& cam, gint packet_size) {
+                    GuardedGError err;
+                    arv_camera_gv_set_packet_size(cam.get(), packet_size, err.storeError());
+                    LOG_GERROR_ARAVIS(err);
+                }
+
+                guint auto_packet_size(const NonOwnedGPtr<ArvCamera>& cam) {
+                    GuardedGError err;
+                    guint res = arv_camera_gv_auto_packet_size(cam.get(), err.storeError());
+                    LOG_GERROR_ARAVIS(err);
+                    return res;
+                }
             }  // namespace gv
         }      // namespace camera
 
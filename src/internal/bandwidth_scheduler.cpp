@@ -0,0 +1,104 @@
+#include <camera_aravis_internal/bandwidth_scheduler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <ros/console.h>
+
+namespace camera_aravis::internal {
+
+    namespace {
+        // Ethernet header (14), FCS (4), preamble (8) and inter-frame gap (12) around each IP packet
+        constexpr double ETHERNET_OVERHEAD_BYTES = 38.0;
+
+        double wire_bits(const BandwidthScheduler::Member& member) {
+            return (member.packet_size + ETHERNET_OVERHEAD_BYTES) * 8.0;
+        }
+
+        uint64_t to_ticks(double seconds, uint64_t tick_frequency) {
+            return static_cast<uint64_t>(std::llround(std::max(0.0, seconds) * tick_frequency));
+        }
+    }  // namespace
+
+    BandwidthScheduler& BandwidthScheduler::instance() {
+        static BandwidthScheduler scheduler;
+        return scheduler;
+    }
+
+    uint64_t BandwidthScheduler::add(const Member& member) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const uint64_t id = next_id_++;
+        members_[id] = member;
+        schedule(member.group);
+        return id;
+    }
+
+    void BandwidthScheduler::remove(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = members_.find(id);
+        if (it == members_.end()) { return; }
+
+        const std::string group = it->second.group;
+        members_.erase(it);
+        schedule(group);
+    }
+
+    void BandwidthScheduler::schedule(const std::string& group) {
+        std::vector<Member*> members;
+        for (auto& entry : members_) {
+            if (entry.second.group == group) { members.push_back(&entry.second); }
+        }
+        if (members.empty()) { return; }
+
+        double link_bps = 0.0, utilization = 1.0, required_bps = 0.0, slot_bits = 0.0;
+        bool rates_known = true;
+        for (const Member* member : members) {
+            const double member_link_bps = member->shared_link_bps > 0.0 ? member->shared_link_bps
+                                                                          : member->link_speed_bps;
+            if (member_link_bps > 0.0) {
+                link_bps = link_bps > 0.0 ? std::min(link_bps, member_link_bps) : member_link_bps;
+            }
+            utilization = std::min(utilization, member->utilization);
+            rates_known = rates_known && member->frame_rate > 0.0;
+            required_bps += member->packets_per_frame * wire_bits(*member) * member->frame_rate;
+            slot_bits += wire_bits(*member);
+        }
+        if (link_bps <= 0.0) {
+            ROS_WARN("Bandwidth scheduling: link speed of interface %s unknown, streams are not paced", group.c_str());
+            return;
+        }
+
+        const double budget_bps = link_bps * std::clamp(utilization, 0.01, 1.0);
+        if (rates_known && required_bps > budget_bps) {
+            ROS_WARN("Bandwidth scheduling: streams on interface %s need %.0f Mbit/s, exceeding the budget of "
+                     "%.0f Mbit/s",
+                     group.c_str(), required_bps * 1e-6, budget_bps * 1e-6);
+        }
+
+        // one packet of average size at the budget rate
+        const double slot_s = slot_bits / members.size() / budget_bps;
+
+        for (size_t i = 0; i < members.size(); ++i) {
+            Member& member = *members[i];
+
+            Allocation allocation;
+            allocation.required_bps = member.packets_per_frame * wire_bits(member) * member.frame_rate;
+            allocation.allocated_bps = rates_known && allocation.required_bps > 0.0
+                                           ? budget_bps * allocation.required_bps / required_bps
+                                           : budget_bps / members.size();
+            allocation.budget_bps = budget_bps;
+
+            // the camera needs bits / link speed to send a packet, the delay makes up the rest of its share
+            const double bits = wire_bits(member);
+            const double member_link_bps = member.link_speed_bps > 0.0 ? member.link_speed_bps : link_bps;
+            allocation.packet_delay_s = bits / allocation.allocated_bps - bits / member_link_bps;
+            allocation.frame_delay_s = i * slot_s;
+            allocation.packet_delay_ticks = to_ticks(allocation.packet_delay_s, member.tick_frequency);
+            allocation.frame_delay_ticks = to_ticks(allocation.frame_delay_s, member.tick_frequency);
+
+            if (member.apply) { member.apply(allocation); }
+        }
+    }
+
+}  // namespace camera_aravis::internal
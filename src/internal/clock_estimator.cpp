@@ -0,0 +1,153 @@
+#include <camera_aravis_internal/clock_estimator.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace camera_aravis::internal {
+
+    namespace {
+        // quantile of the first n values, reorders them
+        double quantile(std::vector<double>& values, size_t n, double q) {
+            const size_t k = std::min(n - 1, static_cast<size_t>(q * (n - 1) + 0.5));
+            std::nth_element(values.begin(), values.begin() + k, values.begin() + n);
+            return values[k];
+        }
+    }  // namespace
+
+    ClockEstimator::ClockEstimator(size_t window, double envelope_quantile, size_t refit_interval):
+        envelope_quantile_(std::clamp(envelope_quantile, 0.0, 1.0)),
+        refit_interval_(std::max<size_t>(refit_interval, 1)),
+        samples_(std::max<size_t>(window, 16)),
+        scratch_(samples_.size()),
+        inlier_(samples_.size()) {}
+
+    void ClockEstimator::reset(uint64_t camera_ns, uint64_t host_ns) {
+        if (initialized_) { ++n_resets_; }
+        initialized_ = true;
+        camera_ref_ns_ = camera_ns;
+        host_ref_ns_ = host_ns;
+        head_ = 0;
+        n_samples_ = 0;
+        n_since_fit_ = 0;
+        last_x_ = 0.0;
+        rate_ = 1.0;
+        intercept_ = 0.0;
+        residual_stddev_s_ = 0.0;
+        residual_max_s_ = 0.0;
+    }
+
+    uint64_t ClockEstimator::update(uint64_t camera_ns, uint64_t host_ns) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!initialized_ || camera_ns < camera_ref_ns_) { reset(camera_ns, host_ns); }
+
+        const double x = (camera_ns - camera_ref_ns_) * 1e-9;
+        const double y = (static_cast<int64_t>(host_ns - host_ref_ns_)) * 1e-9;
+        if (x < last_x_ || std::abs(y - predict(x)) > MAX_DEVIATION_S) {
+            reset(camera_ns, host_ns);
+            return host_ns;
+        }
+        last_x_ = x;
+
+        samples_[head_] = Sample{x, y};
+        head_ = (head_ + 1) % samples_.size();
+        n_samples_ = std::min(n_samples_ + 1, samples_.size());
+
+        // until the first fit, the earliest arrival relative to the camera clock gives the offset
+        if (n_samples_ <= refit_interval_) {
+            intercept_ = n_samples_ == 1 ? y - x : std::min(intercept_, y - x);
+        }
+        if (++n_since_fit_ >= refit_interval_) {
+            n_since_fit_ = 0;
+            fit();
+        }
+
+        return host_ref_ns_ + static_cast<int64_t>(std::llround(predict(x) * 1e9));
+    }
+
+    uint64_t ClockEstimator::map(uint64_t camera_ns) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!initialized_) { return 0; }
+
+        const double x = static_cast<int64_t>(camera_ns - camera_ref_ns_) * 1e-9;
+        return host_ref_ns_ + static_cast<int64_t>(std::llround(predict(x) * 1e9));
+    }
+
+    void ClockEstimator::fit() {
+        const size_t n = n_samples_;
+
+        // least squares over the inliers, centered for precision
+        auto fit_line = [this, n](double& rate, double& intercept) {
+            double n_inliers = 0.0, mx = 0.0, my = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                if (!inlier_[i]) { continue; }
+                n_inliers += 1.0;
+                mx += samples_[i].x;
+                my += samples_[i].y;
+            }
+            mx /= n_inliers;
+            my /= n_inliers;
+
+            double sxx = 0.0, sxy = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                if (!inlier_[i]) { continue; }
+                sxx += (samples_[i].x - mx) * (samples_[i].x - mx);
+                sxy += (samples_[i].x - mx) * (samples_[i].y - my);
+            }
+
+            // the rate is only determined over a long enough span, a wild estimate is worse than none
+            const double span = std::sqrt(sxx / n_inliers) * 2.0;
+            rate = span >= MIN_SPAN_S && sxx > 0.0 ? std::clamp(sxy / sxx, 1.0 - MAX_DRIFT, 1.0 + MAX_DRIFT) : 1.0;
+            intercept = my - rate * mx;
+        };
+
+        std::fill(inlier_.begin(), inlier_.begin() + n, 1);
+        double rate, intercept;
+        fit_line(rate, intercept);
+
+        // reject outliers by the median absolute deviation of the residuals
+        for (size_t i = 0; i < n; ++i) { scratch_[i] = samples_[i].y - (intercept + rate * samples_[i].x); }
+        const double median = quantile(scratch_, n, 0.5);
+        for (size_t i = 0; i < n; ++i) {
+            scratch_[i] = std::abs(samples_[i].y - (intercept + rate * samples_[i].x) - median);
+        }
+        const double threshold = std::max(3.0 * 1.4826 * quantile(scratch_, n, 0.5), 1e-6);
+        for (size_t i = 0; i < n; ++i) {
+            inlier_[i] = std::abs(samples_[i].y - (intercept + rate * samples_[i].x) - median) <= threshold;
+        }
+        fit_line(rate, intercept);
+
+        // statistics of the inlier residuals, then shift the line to their lower envelope
+        size_t n_inliers = 0;
+        double sum = 0.0, sum_sq = 0.0, max = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            if (!inlier_[i]) { continue; }
+            const double r = samples_[i].y - (intercept + rate * samples_[i].x);
+            scratch_[n_inliers++] = r;
+            sum += r;
+            sum_sq += r * r;
+            max = std::max(max, std::abs(r));
+        }
+        const double mean = sum / n_inliers;
+        residual_stddev_s_ = std::sqrt(std::max(0.0, sum_sq / n_inliers - mean * mean));
+        residual_max_s_ = max;
+
+        rate_ = rate;
+        intercept_ = intercept + quantile(scratch_, n_inliers, envelope_quantile_);
+    }
+
+    ClockEstimator::Statistics ClockEstimator::get_statistics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Statistics res;
+        res.valid = n_samples_ > refit_interval_;
+        res.n_samples = n_samples_;
+        res.n_resets = n_resets_;
+        res.offset_s = (static_cast<double>(host_ref_ns_) - static_cast<double>(camera_ref_ns_)) * 1e-9 +
+                       predict(last_x_) - last_x_;
+        res.drift_ppm = (rate_ - 1.0) * 1e6;
+        res.residual_stddev_s = residual_stddev_s_;
+        res.residual_max_s = residual_max_s_;
+        return res;
+    }
+
+}  // namespace camera_aravis::internal
@@ -0,0 +1,100 @@
+#include <camera_aravis_internal/control_executor.h>
+
+#include <algorithm>
+
+#include <ros/console.h>
+
+#include <camera_aravis_internal/trace.h>
+
+namespace camera_aravis::internal {
+
+    ControlExecutor::ControlExecutor() { worker_ = std::thread(&ControlExecutor::spin, this); }
+
+    ControlExecutor::~ControlExecutor() { stop(); }
+
+    void ControlExecutor::post(Priority priority, std::function<void()> fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) { return; }
+            queue_.push(Request{priority, sequence_++, std::chrono::steady_clock::now(), std::move(fn)});
+            ++statistics_[priority].n_pending;
+        }
+        cv_.notify_one();
+    }
+
+    void ControlExecutor::stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+        if (worker_.joinable() && std::this_thread::get_id() != worker_.get_id()) { worker_.join(); }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!queue_.empty()) { queue_.pop(); }
+        for (auto& stats : statistics_) { stats.n_pending = 0; }
+    }
+
+    bool ControlExecutor::is_running() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return running_;
+    }
+
+    ControlExecutor::Statistics ControlExecutor::get_statistics(Priority priority) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ClassStatistics& stats = statistics_[priority];
+
+        Statistics res;
+        res.n_requests = stats.n_requests;
+        res.n_pending = stats.n_pending;
+        res.n_window = stats.n_window;
+        res.mean_latency_ms = stats.n_window > 0 ? stats.sum_latency_ms / stats.n_window : 0.0;
+        res.max_latency_ms = stats.max_latency_ms;
+
+        stats.n_window = 0;
+        stats.sum_latency_ms = 0.0;
+        stats.max_latency_ms = 0.0;
+        return res;
+    }
+
+    const char* ControlExecutor::priority_name(Priority priority) {
+        switch (priority) {
+            case TRIGGER: return "Trigger";
+            case ACQUISITION: return "Acquisition";
+            case SERVICE: return "Service";
+            case DIAGNOSTICS: return "Diagnostics";
+            default: return "Unknown";
+        }
+    }
+
+    void ControlExecutor::spin() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (!running_) { return; }
+
+            Request request = queue_.top();
+            queue_.pop();
+
+            ClassStatistics& stats = statistics_[request.priority];
+            const double latency_ms =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - request.enqueued).count();
+            --stats.n_pending;
+            ++stats.n_requests;
+            ++stats.n_window;
+            stats.sum_latency_ms += latency_ms;
+            stats.max_latency_ms = std::max(stats.max_latency_ms, latency_ms);
+
+            CA_TRACE_COUNTER("control queue", queue_.size());
+            lock.unlock();
+            try {
+                CA_TRACE_SCOPE(priority_name(request.priority));
+                request.fn();
+            } catch (const std::exception& e) {
+                ROS_ERROR("camera_aravis: %s control request failed: %s", priority_name(request.priority), e.what());
+            }
+            lock.lock();
+        }
+    }
+
+}  // namespace camera_aravis::internal
@@ -0,0 +1,338 @@
+#include <camera_aravis_internal/feature_value_cache.h>
+
+#include <list>
+
+#include <boost/algorithm/string/trim.hpp>
+
+namespace camera_aravis::aravis::device::feature {
+
+    namespace {
+        std::string get_text(ArvDomNode* node) {
+            ArvDomNode* child = arv_dom_node_get_first_child(node);
+            const char* value = child ? arv_dom_node_get_node_value(child) : nullptr;
+            return value ? boost::trim_copy(std::string(value)) : std::string();
+        }
+
+        // Properties referencing nodes which provide (a part of) the value or the location of a feature, or its
+        // limits and availability, which clients read together with the value
+        bool is_value_reference(const std::string& name) {
+            return name == "pValue" || name == "pVariable" || name == "pAddress" || name == "pIndex" ||
+                   name == "pLength" || name == "pValueDefault" || name == "pMin" || name == "pMax" ||
+                   name == "pInc" || name == "pIsAvailable" || name == "pIsImplemented";
+        }
+    }  // namespace
+
+    double ValueCache::Statistics::hit_rate() const {
+        const uint64_t n_reads = hits + misses + uncachable;
+        return n_reads > 0 ? static_cast<double>(hits) / n_reads : 0.0;
+    }
+
+    ValueCache::ValueCache(const NonOwnedGPtr<ArvDevice>& dev): device_(dev) {}
+
+    const ValueCache::Policy& ValueCache::get_policy(const char* feat) {
+        auto iter = policies_.find(feat);
+        if (iter != policies_.end()) return iter->second;
+
+        Policy& policy = policies_[feat];
+
+        ArvGcNode* root = get_node(device_, feat);
+        ArvGc* gc = device_ ? arv_device_get_genicam(device_.get()) : nullptr;
+        policy.node = root;
+        if (!root || !gc) {
+            policy.cachable = false;
+            return policy;
+        }
+
+        // walk all nodes the value is computed from, similar to internal::discover_features()
+        std::unordered_set<ArvDomNode*> done;
+        std::list<ArvDomNode*> todo;
+        todo.push_front(ARV_DOM_NODE(root));
+
+        while (!todo.empty()) {
+            ArvDomNode* node = todo.front();
+            todo.pop_front();
+
+            if (done.find(node) != done.end()) continue;
+            done.insert(node);
+
+            if (node != ARV_DOM_NODE(root) && ARV_IS_GC_FEATURE_NODE(node)) {
+                policy.dependencies.emplace(arv_gc_feature_node_get_name(ARV_GC_FEATURE_NODE(node)));
+            }
+
+            ArvDomNodeList* children = arv_dom_node_get_child_nodes(node);
+            const uint l = arv_dom_node_list_get_length(children);
+            for (uint i = 0; i < l; ++i) {
+                ArvDomNode* child = arv_dom_node_list_get_item(children, i);
+                const char* child_name = arv_dom_node_get_node_name(child);
+                if (!child_name) continue;
+
+                const std::string name(child_name);
+                if (name == "Cachable") {
+                    if (get_text(child) == "NoCache") policy.cachable = false;
+                } else if (name == "PollingTime") {
+                    // the device changes the value by itself
+                    policy.cachable = false;
+                } else if (name == "pInvalidator" || name == "pIsLocked") {
+                    policy.dependencies.emplace(get_text(child));
+                } else if (is_value_reference(name)) {
+                    ArvGcNode* ref = arv_gc_get_node(gc, get_text(child).c_str());
+                    if (ref) todo.push_front(ARV_DOM_NODE(ref));
+                }
+            }
+        }
+
+        return policy;
+    }
+
+    template<typename T>
+    bool ValueCache::lookup(const char* feat, const Policy& policy, ValueType type, T Entry::*member, T& out) {
+        if (!policy.cachable) {
+            ++n_uncachable_;
+            return false;
+        }
+
+        auto iter = entries_.find(feat);
+        if (iter == entries_.end() || !(iter->second.valid & type)) {
+            ++n_misses_;
+            return false;
+        }
+
+        ++n_hits_;
+        out = iter->second.*member;
+        return true;
+    }
+
+    template<typename T>
+    void ValueCache::store(const char* feat, const Policy& policy, ValueType type, T Entry::*member, const T& val) {
+        if (!policy.cachable) return;
+
+        Entry& entry = entries_[feat];
+        entry.*member = val;
+        entry.valid |= type;
+    }
+
+    gboolean ValueCache::get_boolean(const char* feat) {
+        GuardedGError err;
+        gboolean res = get_boolean(feat, err);
+        LOG_GERROR_ARAVIS(err);
+        return res;
+    }
+
+    gboolean ValueCache::get_boolean(const char* feat, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        gboolean res = FALSE;
+        const Policy& policy = get_policy(feat);
+        if (lookup(feat, policy, BOOLEAN, &Entry::boolean, res)) return res;
+
+        res = Boolean(policy.node, feat).get(err);
+        if (!err) store(feat, policy, BOOLEAN, &Entry::boolean, res);
+        return res;
+    }
+
+    gint64 ValueCache::get_integer(const char* feat) {
+        GuardedGError err;
+        gint64 res = get_integer(feat, err);
+        LOG_GERROR_ARAVIS(err);
+        return res;
+    }
+
+    gint64 ValueCache::get_integer(const char* feat, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        gint64 res = 0;
+        const Policy& policy = get_policy(feat);
+        if (lookup(feat, policy, INTEGER, &Entry::integer, res)) return res;
+
+        res = Integer(policy.node, feat).get(err);
+        if (!err) store(feat, policy, INTEGER, &Entry::integer, res);
+        return res;
+    }
+
+    double ValueCache::get_float(const char* feat) {
+        GuardedGError err;
+        double res = get_float(feat, err);
+        LOG_GERROR_ARAVIS(err);
+        return res;
+    }
+
+    double ValueCache::get_float(const char* feat, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        double res = 0.0;
+        const Policy& policy = get_policy(feat);
+        if (lookup(feat, policy, FLOAT, &Entry::real, res)) return res;
+
+        res = Float(policy.node, feat).get(err);
+        if (!err) store(feat, policy, FLOAT, &Entry::real, res);
+        return res;
+    }
+
+    std::string ValueCache::get_string(const char* feat) {
+        GuardedGError err;
+        std::string res = get_string(feat, err);
+        LOG_GERROR_ARAVIS(err);
+        return res;
+    }
+
+    std::string ValueCache::get_string(const char* feat, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        std::string res;
+        const Policy& policy = get_policy(feat);
+        if (lookup(feat, policy, STRING, &Entry::string, res)) return res;
+
+        const char* val = String(policy.node, feat).get(err);
+        res = val ? val : "";
+        if (!err) store(feat, policy, STRING, &Entry::string, res);
+        return res;
+    }
+
+    gboolean ValueCache::read_boolean(const char* feat) {
+        GuardedGError err;
+        gboolean res = read_boolean(feat, err);
+        LOG_GERROR_ARAVIS(err);
+        return res;
+    }
+
+    gboolean ValueCache::read_boolean(const char* feat, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        const Policy& policy = get_policy(feat);
+        const gboolean res = Boolean(policy.node, feat).get(err);
+        if (!err) store(feat, policy, BOOLEAN, &Entry::boolean, res);
+        return res;
+    }
+
+    gint64 ValueCache::read_integer(const char* feat) {
+        GuardedGError err;
+        gint64 res = read_integer(feat, err);
+        LOG_GERROR_ARAVIS(err);
+        return res;
+    }
+
+    gint64 ValueCache::read_integer(const char* feat, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        const Policy& policy = get_policy(feat);
+        const gint64 res = Integer(policy.node, feat).get(err);
+        if (!err) store(feat, policy, INTEGER, &Entry::integer, res);
+        return res;
+    }
+
+    double ValueCache::read_float(const char* feat) {
+        GuardedGError err;
+        double res = read_float(feat, err);
+        LOG_GERROR_ARAVIS(err);
+        return res;
+    }
+
+    double ValueCache::read_float(const char* feat, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        const Policy& policy = get_policy(feat);
+        const double res = Float(policy.node, feat).get(err);
+        if (!err) store(feat, policy, FLOAT, &Entry::real, res);
+        return res;
+    }
+
+    std::string ValueCache::read_string(const char* feat) {
+        GuardedGError err;
+        std::string res = read_string(feat, err);
+        LOG_GERROR_ARAVIS(err);
+        return res;
+    }
+
+    std::string ValueCache::read_string(const char* feat, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        const Policy& policy = get_policy(feat);
+        const char* val = String(policy.node, feat).get(err);
+        const std::string res = val ? val : "";
+        if (!err) store(feat, policy, STRING, &Entry::string, res);
+        return res;
+    }
+
+    void ValueCache::set_boolean(const char* feat, gboolean val) {
+        GuardedGError err;
+        set_boolean(feat, val, err);
+        LOG_GERROR_ARAVIS(err);
+    }
+
+    void ValueCache::set_boolean(const char* feat, gboolean val, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        Boolean(get_policy(feat).node, feat).set(val, err);
+        // a rejected write leaves the device as it was
+        if (!err) invalidate(feat);
+    }
+
+    void ValueCache::set_integer(const char* feat, gint64 val) {
+        GuardedGError err;
+        set_integer(feat, val, err);
+        LOG_GERROR_ARAVIS(err);
+    }
+
+    void ValueCache::set_integer(const char* feat, gint64 val, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        Integer(get_policy(feat).node, feat).set(val, err);
+        if (!err) invalidate(feat);
+    }
+
+    void ValueCache::set_float(const char* feat, double val) {
+        GuardedGError err;
+        set_float(feat, val, err);
+        LOG_GERROR_ARAVIS(err);
+    }
+
+    void ValueCache::set_float(const char* feat, double val, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        Float(get_policy(feat).node, feat).set(val, err);
+        if (!err) invalidate(feat);
+    }
+
+    void ValueCache::set_string(const char* feat, const char* val) {
+        GuardedGError err;
+        set_string(feat, val, err);
+        LOG_GERROR_ARAVIS(err);
+    }
+
+    void ValueCache::set_string(const char* feat, const char* val, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        String(get_policy(feat).node, feat).set(val, err);
+        if (!err) invalidate(feat);
+    }
+
+    void ValueCache::execute_command(const char* cmd) {
+        GuardedGError err;
+        execute_command(cmd, err);
+        LOG_GERROR_ARAVIS(err);
+    }
+
+    void ValueCache::execute_command(const char* cmd, GuardedGError& err) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        Command(get_policy(cmd).node, cmd).execute(err);
+        // also on errors, the command may have run although its acknowledge was lost
+        clear();
+    }
+
+    void ValueCache::invalidate(const std::string& feat) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        for (auto iter = entries_.begin(); iter != entries_.end();) {
+            const Policy& policy = get_policy(iter->first.c_str());
+            if (iter->first == feat || policy.dependencies.count(feat) > 0) {
+                iter = entries_.erase(iter);
+                ++n_invalidations_;
+            } else {
+                ++iter;
+            }
+        }
+    }
+
+    void ValueCache::clear() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        n_invalidations_ += entries_.size();
+        entries_.clear();
+    }
+
+    ValueCache::Statistics ValueCache::get_statistics() const {
+        Statistics stats;
+        stats.hits = n_hits_;
+        stats.misses = n_misses_;
+        stats.uncachable = n_uncachable_;
+        stats.invalidations = n_invalidations_;
+        return stats;
+    }
+
+}  // namespace camera_aravis::aravis::device::feature
@@ -0,0 +1,174 @@
+#include <camera_aravis/camera_aravis_nodelet.h>
+
+#include <map>
+
+#include <camera_aravis_internal/GErrorGuard.h>
+#include <camera_aravis_internal/GErrorROSLog.h>
+#include <camera_aravis_internal/aravis_abstraction.h>
+#include <camera_aravis_internal/control_executor.h>
+#include <camera_aravis_internal/feature_value_cache.h>
+
+namespace camera_aravis {
+
+    namespace {
+        // Value type to report a feature with, derived from its GenICam node. Enumerations are reported by name.
+        bool get_watch_type(ArvGcNode* node, uint8_t& type) {
+            if (!node) return false;
+
+            if (ARV_IS_GC_BOOLEAN(node)) {
+                type = FeatureValue::BOOLEAN;
+            } else if (ARV_IS_GC_ENUMERATION(node) || ARV_IS_GC_STRING(node)) {
+                type = FeatureValue::STRING;
+            } else if (ARV_IS_GC_INTEGER(node)) {
+                type = FeatureValue::INTEGER;
+            } else if (ARV_IS_GC_FLOAT(node)) {
+                type = FeatureValue::FLOAT;
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        bool equal_values(const FeatureValue& lhs, const FeatureValue& rhs) {
+            switch (lhs.type) {
+                case FeatureValue::INTEGER: return lhs.integer_value == rhs.integer_value;
+                case FeatureValue::FLOAT: return lhs.float_value == rhs.float_value;
+                case FeatureValue::STRING: return lhs.string_value == rhs.string_value;
+                case FeatureValue::BOOLEAN: return lhs.boolean_value == rhs.boolean_value;
+                default: return false;
+            }
+        }
+    }  // namespace
+
+    // The watch list is given as parameter 'feature_watch', a list of feature names or of {feature, rate} entries:
+    //
+    //   feature_watch_rate: 1.0
+    //   feature_watch:
+    //     - DeviceTemperature
+    //     - {feature: ExposureTime, rate: 10.0}
+    //
+    // Features polled at the same rate share one timer and are published together.
+    void CameraAravisNodelet::setupFeatureWatch(ros::NodeHandle& pnh) {
+        XmlRpc::XmlRpcValue xml_rpc_params;
+        if (!pnh.getParam("feature_watch", xml_rpc_params)) { return; }
+        if (xml_rpc_params.getType() != XmlRpc::XmlRpcValue::TypeArray) {
+            ROS_WARN("Camera aravis: parameter feature_watch must be a list, no features are watched");
+            return;
+        }
+
+        const double default_rate = pnh.param<double>("feature_watch_rate", 1.0);
+
+        std::map<double, std::vector<WatchedFeature>> features_by_rate;
+        for (int32_t i = 0; i < xml_rpc_params.size(); ++i) {
+            XmlRpc::XmlRpcValue& elem = xml_rpc_params[i];
+
+            WatchedFeature watched;
+            double rate = default_rate;
+            if (elem.getType() == XmlRpc::XmlRpcValue::TypeString) {
+                watched.value.feature = static_cast<std::string>(elem);
+            } else if (elem.getType() == XmlRpc::XmlRpcValue::TypeStruct && elem.hasMember("feature")) {
+                watched.value.feature = static_cast<std::string>(elem["feature"]);
+                if (elem.hasMember("rate")) {
+                    XmlRpc::XmlRpcValue& r = elem["rate"];
+                    rate = r.getType() == XmlRpc::XmlRpcValue::TypeInt ? static_cast<int>(r) : static_cast<double>(r);
+                }
+            } else {
+                ROS_WARN("Camera aravis: ignoring invalid entry %d of parameter feature_watch", i);
+                continue;
+            }
+
+            watched.node = aravis::device::feature::get_node(device, watched.value.feature.c_str());
+            if (!isImplemented(watched.value.feature) || !get_watch_type(watched.node, watched.value.type)) {
+                ROS_WARN("Camera aravis: cannot watch feature %s, it is not implemented or has no value",
+                         watched.value.feature.c_str());
+                continue;
+            }
+            if (rate <= 0.0) {
+                ROS_WARN("Camera aravis: invalid watch rate %f of feature %s", rate, watched.value.feature.c_str());
+                continue;
+            }
+
+            features_by_rate[rate].push_back(std::move(watched));
+        }
+
+        if (features_by_rate.empty()) { return; }
+
+        feature_changes_publisher_ = pnh.advertise<FeatureChanges>(
+            "feature_changes", 10,
+            // a new subscriber needs the full state, not only what changes from now on
+            [this](const ros::SingleSubscriberPublisher&) { ++feature_watch_generation_; });
+
+        feature_watches_.resize(features_by_rate.size());
+        size_t idx = 0;
+        for (auto& elem : features_by_rate) {
+            FeatureWatch& watch = feature_watches_[idx++];
+            watch.features = std::move(elem.second);
+            for (const WatchedFeature& watched : watch.features) {
+                ROS_INFO("Camera aravis: watching feature %s at %.2f Hz", watched.value.feature.c_str(), elem.first);
+            }
+
+            watch.timer = pnh.createTimer(ros::Duration(ros::Rate(elem.first)),
+                                          [this, &watch](const ros::TimerEvent&) { pollFeatureWatch(watch); });
+        }
+    }
+
+    void CameraAravisNodelet::pollFeatureWatch(FeatureWatch& watch) {
+        if (feature_changes_publisher_.getNumSubscribers() == 0) { return; }
+
+        const uint32_t generation = feature_watch_generation_;
+        const bool publish_all = generation != watch.generation;
+        watch.generation = generation;
+
+        FeatureChanges msg;
+        msg.header.frame_id = frame_id_;
+
+        // all features of a watch are read in one go, from the device: the cache would hide the changes the camera
+        // makes by itself (e.g. ExposureTime under ExposureAuto), which are the point of watching
+        control(internal::ControlExecutor::DIAGNOSTICS, [&]() {
+            const auto lock = feature_cache_->lock();
+            msg.header.stamp = ros::Time::now();
+
+            for (WatchedFeature& watched : watch.features) {
+                GuardedGError error;
+                FeatureValue value;
+                value.feature = watched.value.feature;
+                value.type = watched.value.type;
+
+                const char* feature_name = value.feature.c_str();
+                switch (value.type) {
+                    case FeatureValue::INTEGER:
+                        value.integer_value = aravis::device::feature::Integer(watched.node, feature_name).get(error);
+                        break;
+                    case FeatureValue::FLOAT:
+                        value.float_value = aravis::device::feature::Float(watched.node, feature_name).get(error);
+                        break;
+                    case FeatureValue::STRING: {
+                        const char* str = aravis::device::feature::String(watched.node, feature_name).get(error);
+                        value.string_value = str ? str : "";
+                        break;
+                    }
+                    case FeatureValue::BOOLEAN:
+                        value.boolean_value = aravis::device::feature::Boolean(watched.node, feature_name).get(error);
+                        break;
+                }
+
+                if (error) {
+                    ROS_WARN_THROTTLE(10.0, "Camera aravis: failed to read watched feature %s", feature_name);
+                    continue;
+                }
+
+                const bool changed = watched.valid && !equal_values(value, watched.value);
+                // the camera changed it, a value cached before is stale
+                if (changed) { feature_cache_->invalidate(value.feature); }
+
+                if (publish_all || !watched.valid || changed) {
+                    watched.value = value;
+                    watched.valid = true;
+                    msg.changes.push_back(std::move(value));
+                }
+            }
+        });
+
+        if (!msg.changes.empty()) { feature_changes_publisher_.publish(msg); }
+    }
+}  // namespace camera_aravis
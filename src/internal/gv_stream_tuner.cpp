@@ -0,0 +1,65 @@
+#include <camera_aravis_internal/gv_stream_tuner.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace camera_aravis::internal {
+
+    namespace {
+        guint scale(guint value, double factor, guint min, guint max) {
+            return std::clamp(static_cast<guint>(std::lround(value * factor)), min, std::max(min, max));
+        }
+    }  // namespace
+
+    GvStreamTuner::GvStreamTuner(const GvStreamOptions& options, const Bounds& bounds):
+        options_(options), bounds_(bounds) {}
+
+    bool GvStreamTuner::update(const Observation& observation) {
+        if (observation.n_frames == 0 && observation.n_failures == 0) { return false; }
+
+        const GvStreamOptions previous = options_;
+
+        guint max_frame_retention_ms = bounds_.max_frame_retention_ms;
+        if (observation.interval_mean_s > 0.0) {
+            const guint latency_cap_ms =
+                static_cast<guint>(observation.interval_mean_s * FRAME_RETENTION_INTERVALS * 1e3);
+            max_frame_retention_ms = std::max(bounds_.min_frame_retention_ms,
+                                              std::min(max_frame_retention_ms, latency_cap_ms));
+        }
+
+        const bool lost = observation.n_missing > 0 || observation.n_failures > 0;
+        if (lost || observation.n_resent > 0) {
+            n_clean_windows_ = 0;
+
+            // the automatic socket buffer is sized by aravis
+            if (!options_.auto_socket_buffer) {
+                const guint size = std::max(options_.socket_buffer_size, INITIAL_SOCKET_BUFFER_SIZE / 2);
+                options_.socket_buffer_size = std::min(size * 2, std::max(size, bounds_.max_socket_buffer_size));
+            }
+            if (observation.n_missing > 0 && options_.packet_resend) {
+                options_.packet_timeout_ms = scale(options_.packet_timeout_ms, 1.5, bounds_.min_packet_timeout_ms,
+                                                   bounds_.max_packet_timeout_ms);
+            }
+            if (observation.n_failures > 0) {
+                options_.frame_retention_ms = scale(options_.frame_retention_ms, 1.5, bounds_.min_frame_retention_ms,
+                                                    max_frame_retention_ms);
+            }
+        } else if (++n_clean_windows_ >= N_CLEAN_WINDOWS) {
+            n_clean_windows_ = 0;
+            options_.packet_timeout_ms = scale(options_.packet_timeout_ms, 0.9, bounds_.min_packet_timeout_ms,
+                                               bounds_.max_packet_timeout_ms);
+            options_.frame_retention_ms = scale(options_.frame_retention_ms, 0.9, bounds_.min_frame_retention_ms,
+                                                max_frame_retention_ms);
+        }
+
+        // keep the retention consistent with a changed frame rate, and leave time for a resend within it
+        options_.frame_retention_ms = std::min(options_.frame_retention_ms, max_frame_retention_ms);
+        options_.packet_timeout_ms = std::min(options_.packet_timeout_ms,
+                                              std::max(bounds_.min_packet_timeout_ms, options_.frame_retention_ms / 2));
+
+        return options_.socket_buffer_size != previous.socket_buffer_size ||
+               options_.packet_timeout_ms != previous.packet_timeout_ms ||
+               options_.frame_retention_ms != previous.frame_retention_ms;
+    }
+
+}  // namespace camera_aravis::internal
@@ -0,0 +1,250 @@
+#include <camera_aravis_internal/gvsp_receiver.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace camera_aravis::internal {
+
+    namespace {
+        enum PacketFormat : uint8_t { LEADER = 1, TRAILER = 2, PAYLOAD = 3 };
+        constexpr uint16_t PAYLOAD_TYPE_IMAGE = 0x0001;
+        constexpr uint8_t EXTENDED_ID_FLAG = 0x80;
+
+        constexpr size_t HEADER_SIZE = 8;
+        constexpr size_t EXTENDED_HEADER_SIZE = 20;
+        constexpr size_t IMAGE_LEADER_SIZE = 36;
+
+        uint16_t read_be16(const uint8_t* p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+
+        uint32_t read_be32(const uint8_t* p) {
+            return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+                   static_cast<uint32_t>(p[2]) << 8 | p[3];
+        }
+
+        uint64_t read_be64(const uint8_t* p) { return static_cast<uint64_t>(read_be32(p)) << 32 | read_be32(p + 4); }
+
+        uint64_t host_time_ns() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        }
+    }  // namespace
+
+    GvspReceiver::GvspReceiver(const Config& config, FrameCallback callback):
+        config_(config), callback_(std::move(callback)) {}
+
+    GvspReceiver::~GvspReceiver() { stop(); }
+
+    bool GvspReceiver::start(std::string& error) {
+        in_addr group{}, interface{};
+        if (inet_pton(AF_INET, config_.address.c_str(), &group) != 1 || !IN_MULTICAST(ntohl(group.s_addr))) {
+            error = "invalid multicast address '" + config_.address + "'";
+            return false;
+        }
+        interface.s_addr = htonl(INADDR_ANY);
+        if (!config_.interface_address.empty() &&
+            inet_pton(AF_INET, config_.interface_address.c_str(), &interface) != 1) {
+            error = "invalid interface address '" + config_.interface_address + "'";
+            return false;
+        }
+
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) {
+            error = std::string("socket: ") + strerror(errno);
+            return false;
+        }
+
+        auto fail = [this, &error](const char* what) {
+            error = std::string(what) + ": " + strerror(errno);
+            close(fd_);
+            fd_ = -1;
+            return false;
+        };
+
+        // several listeners on one host share the group
+        const int reuse = 1;
+        if (setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0) { return fail("SO_REUSEADDR"); }
+        const int socket_buffer_size = config_.socket_buffer_size;
+        if (socket_buffer_size > 0 &&
+            setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &socket_buffer_size, sizeof(socket_buffer_size)) < 0) {
+            return fail("SO_RCVBUF");
+        }
+        // wake up regularly to notice stop()
+        timeval timeout{0, 100000};
+        if (setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) { return fail("SO_RCVTIMEO"); }
+
+        // bound to the group, so that other traffic to the port is not received
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(config_.port);
+        address.sin_addr = group;
+        if (bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) { return fail("bind"); }
+
+        ip_mreq membership{};
+        membership.imr_multiaddr = group;
+        membership.imr_interface = interface;
+        if (setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+            return fail("IP_ADD_MEMBERSHIP");
+        }
+
+        running_ = true;
+        thread_ = std::thread(&GvspReceiver::receive_loop, this);
+        return true;
+    }
+
+    void GvspReceiver::stop() {
+        running_ = false;
+        if (thread_.joinable()) { thread_.join(); }
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    GvspReceiver::Statistics GvspReceiver::get_statistics() const {
+        Statistics res;
+        res.n_completed = n_completed_;
+        res.n_incomplete = n_incomplete_;
+        res.n_packets = n_packets_;
+        res.n_ignored = n_ignored_;
+        return res;
+    }
+
+    void GvspReceiver::receive_loop() {
+        // large enough for jumbo frames
+        std::vector<uint8_t> packet(65536);
+        while (running_) {
+            const ssize_t n_bytes = recv(fd_, packet.data(), packet.size(), 0);
+            if (n_bytes <= 0) { continue; }
+
+            n_packets_.fetch_add(1, std::memory_order_relaxed);
+            handle_packet(packet.data(), n_bytes);
+        }
+    }
+
+    void GvspReceiver::drop_frame() {
+        if (in_frame_) { n_incomplete_.fetch_add(1, std::memory_order_relaxed); }
+        in_frame_ = false;
+    }
+
+    void GvspReceiver::handle_packet(const uint8_t* packet, size_t n_bytes) {
+        if (n_bytes < HEADER_SIZE) {
+            n_ignored_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const uint16_t status = read_be16(packet);
+        const bool extended_id = packet[4] & EXTENDED_ID_FLAG;
+        const uint8_t format = packet[4] & 0x0f;
+        uint64_t block_id = read_be16(packet + 2);
+        uint32_t packet_id = read_be32(packet + 4) & 0x00ffffff;
+        size_t n_bytes_header = HEADER_SIZE;
+        if (extended_id) {
+            if (n_bytes < EXTENDED_HEADER_SIZE) {
+                n_ignored_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            block_id = read_be64(packet + 8);
+            packet_id = read_be32(packet + 16);
+            n_bytes_header = EXTENDED_HEADER_SIZE;
+        }
+
+        if (status != 0) {
+            n_ignored_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const uint8_t* body = packet + n_bytes_header;
+        const size_t n_bytes_body = n_bytes - n_bytes_header;
+
+        switch (format) {
+            case LEADER: {
+                // a new frame, whatever was not finished is lost
+                drop_frame();
+                if (n_bytes_body < IMAGE_LEADER_SIZE || (read_be16(body + 2) & 0x3fff) != PAYLOAD_TYPE_IMAGE) {
+                    n_ignored_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                frame_.block_id = block_id;
+                frame_.timestamp = read_be64(body + 4);
+                frame_.arrival_ns = host_time_ns();
+                frame_.pixel_format = read_be32(body + 12);
+                frame_.width = read_be32(body + 16);
+                frame_.height = read_be32(body + 20);
+
+                // bits per pixel are encoded in the pixel format (PFNC)
+                const size_t n_bits_pixel = (frame_.pixel_format >> 16) & 0xff;
+                n_bytes_expected_ = static_cast<size_t>(frame_.width) * frame_.height * n_bits_pixel / 8;
+                // every byte is overwritten by the payload, a buffer of the right size is kept as it is
+                if (frame_.data.size() != n_bytes_expected_) { frame_.data.resize(n_bytes_expected_); }
+                n_bytes_chunk_ = 0;
+                n_chunks_expected_ = 0;
+                n_chunks_received_ = 0;
+                in_frame_ = true;
+                break;
+            }
+            case PAYLOAD: {
+                if (!in_frame_ || block_id != frame_.block_id || packet_id == 0) {
+                    n_ignored_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                // the first payload packet received is taken as full size, which all but the last one are
+                if (n_bytes_chunk_ == 0) {
+                    if (n_bytes_body == 0) { return; }
+                    n_bytes_chunk_ = n_bytes_body;
+                    n_chunks_expected_ = (n_bytes_expected_ + n_bytes_chunk_ - 1) / n_bytes_chunk_;
+                    packets_received_.assign((n_chunks_expected_ + 63) / 64, 0);
+                }
+                const size_t index = packet_id - 1;
+                const size_t offset = index * n_bytes_chunk_;
+                if (offset >= n_bytes_expected_) { return; }
+
+                // a packet of another size means the guess was wrong (the short last packet overtook the others)
+                // or the packet is broken, either way the offsets cannot be trusted
+                const size_t n = std::min(n_bytes_chunk_, n_bytes_expected_ - offset);
+                if (n_bytes_body > n_bytes_chunk_ || n_bytes_body < n) {
+                    drop_frame();
+                    return;
+                }
+
+                uint64_t& received = packets_received_[index / 64];
+                const uint64_t bit = uint64_t(1) << (index % 64);
+                if (received & bit) {
+                    n_ignored_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                received |= bit;
+
+                std::memcpy(frame_.data.data() + offset, body, n);
+                ++n_chunks_received_;
+                break;
+            }
+            case TRAILER: {
+                if (!in_frame_ || block_id != frame_.block_id) {
+                    n_ignored_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                if (n_bytes_expected_ > 0 && (n_bytes_chunk_ == 0 || n_chunks_received_ < n_chunks_expected_)) {
+                    drop_frame();
+                    return;
+                }
+
+                in_frame_ = false;
+                n_completed_.fetch_add(1, std::memory_order_relaxed);
+                callback_(frame_);
+                break;
+            }
+            default: n_ignored_.fetch_add(1, std::memory_order_relaxed); break;
+        }
+    }
+
+}  // namespace camera_aravis::internal
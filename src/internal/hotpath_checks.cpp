@@ -0,0 +1,150 @@
+#include <camera_aravis_internal/hotpath_checks.h>
+
+#ifdef CAMERA_ARAVIS_HOTPATH_CHECKS
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include <ros/console.h>
+
+namespace {
+    // plain counter, usable before any static initialization and during thread teardown
+    thread_local uint64_t n_thread_allocations = 0;
+
+    void* counted_alloc(std::size_t size) {
+        ++n_thread_allocations;
+        return std::malloc(size > 0 ? size : 1);
+    }
+}  // namespace
+
+void* operator new(std::size_t size) {
+    void* ptr = counted_alloc(size);
+    if (!ptr) { throw std::bad_alloc(); }
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    void* ptr = counted_alloc(size);
+    if (!ptr) { throw std::bad_alloc(); }
+    return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+namespace camera_aravis::internal::hotpath {
+
+    namespace {
+        std::atomic<uint64_t> warmup_frames{Config().warmup_frames};
+        std::atomic<uint64_t> max_lock_wait_ns{Config().max_lock_wait_ns};
+        std::atomic<bool> abort_on_violation{Config().abort_on_violation};
+
+        std::atomic<uint64_t> n_frames{0};
+        std::atomic<uint64_t> n_sections{0};
+        std::atomic<uint64_t> n_allocations{0};
+        std::atomic<uint64_t> n_lock_waits{0};
+        std::atomic<uint64_t> max_wait_ns{0};
+        std::atomic<uint64_t> n_violations{0};
+
+        // nesting depth of sections on this thread, lock waits outside of sections are not checked
+        thread_local int section_depth = 0;
+        // allocations of this thread which were already reported (or made by reporting), not charged to enclosing
+        // sections again
+        thread_local uint64_t n_thread_excluded = 0;
+
+        bool steady_state() { return n_frames.load(std::memory_order_relaxed) >= warmup_frames; }
+
+        void violation() {
+            ++n_violations;
+            if (abort_on_violation) {
+                ROS_FATAL("camera_aravis: hot path violation, aborting");
+                std::abort();
+            }
+        }
+    }  // namespace
+
+    void configure(const Config& config) {
+        warmup_frames = config.warmup_frames;
+        max_lock_wait_ns = config.max_lock_wait_ns;
+        abort_on_violation = config.abort_on_violation;
+
+        const uint64_t n_begin = n_thread_allocations;
+        int* volatile probe = new int;
+        delete probe;
+        if (n_thread_allocations == n_begin) {
+            ROS_WARN("camera_aravis: hot path allocation counting is not in effect, preload the library "
+                     "(LD_PRELOAD) to check allocations");
+        }
+    }
+
+    Statistics get_statistics() {
+        Statistics res;
+        res.n_frames = n_frames;
+        res.n_sections = n_sections;
+        res.n_allocations = n_allocations;
+        res.n_lock_waits = n_lock_waits;
+        res.max_lock_wait_ns = max_wait_ns;
+        res.n_violations = n_violations;
+        return res;
+    }
+
+    void frame_done() { n_frames.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t thread_allocations() { return n_thread_allocations; }
+
+    Section::Section(const char* name):
+        name_(name), n_allocations_begin_(n_thread_allocations), n_excluded_begin_(n_thread_excluded) {
+        ++section_depth;
+    }
+
+    void Section::end() {
+        if (!active_) { return; }
+        active_ = false;
+        --section_depth;
+
+        const uint64_t n =
+            (n_thread_allocations - n_allocations_begin_) - (n_thread_excluded - n_excluded_begin_);
+        n_sections.fetch_add(1, std::memory_order_relaxed);
+        if (n == 0 || !steady_state()) { return; }
+
+        const uint64_t n_reporting_begin = n_thread_allocations;
+        n_allocations += n;
+        ROS_ERROR("camera_aravis: hot path section %s allocated %lu times", name_, static_cast<unsigned long>(n));
+        violation();
+        n_thread_excluded += n + (n_thread_allocations - n_reporting_begin);
+    }
+
+    TimedLockGuard::TimedLockGuard(std::mutex& mutex, const char* name): mutex_(mutex) {
+        if (mutex_.try_lock()) { return; }
+
+        const auto begin = std::chrono::steady_clock::now();
+        mutex_.lock();
+        const uint64_t wait_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+
+        if (section_depth == 0 || !steady_state()) { return; }
+
+        ++n_lock_waits;
+        uint64_t max = max_wait_ns.load(std::memory_order_relaxed);
+        while (wait_ns > max && !max_wait_ns.compare_exchange_weak(max, wait_ns, std::memory_order_relaxed)) {}
+
+        if (wait_ns > max_lock_wait_ns) {
+            const uint64_t n_reporting_begin = n_thread_allocations;
+            ROS_ERROR("camera_aravis: hot path waited %.1f us for %s", wait_ns * 1e-3, name);
+            violation();
+            n_thread_excluded += n_thread_allocations - n_reporting_begin;
+        }
+    }
+
+}  // namespace camera_aravis::internal::hotpath
+
+#endif
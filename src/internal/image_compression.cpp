@@ -0,0 +1,236 @@
+#include <camera_aravis_internal/image_compression.h>
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <vector>
+
+#include <jpeglib.h>
+#include <png.h>
+
+#ifndef JCS_EXTENSIONS
+#error "libjpeg-turbo is required for BGR input"
+#endif
+
+#include <sensor_msgs/image_encodings.h>
+
+#include <camera_aravis/raw12_codec.h>
+
+namespace camera_aravis::internal {
+
+    namespace {
+        namespace enc = sensor_msgs::image_encodings;
+
+        // Layout of an image encoding for the encoders
+        struct Layout {
+            int n_channels = 0;
+            int bit_depth = 0;
+            bool bgr = false;             // color channels in BGR order
+            bool alpha = false;           // 4th channel
+            std::string decoded_encoding;  // as decoded by compressed_image_transport (OpenCV)
+        };
+
+        bool get_layout(const std::string& encoding, Layout& layout) {
+            if (encoding == enc::MONO8) {
+                layout = {1, 8, false, false, enc::MONO8};
+            } else if (encoding == enc::MONO16) {
+                layout = {1, 16, false, false, enc::MONO16};
+            } else if (encoding == enc::RGB8) {
+                layout = {3, 8, false, false, enc::BGR8};
+            } else if (encoding == enc::BGR8) {
+                layout = {3, 8, true, false, enc::BGR8};
+            } else if (encoding == enc::RGBA8) {
+                layout = {4, 8, false, true, enc::BGRA8};
+            } else if (encoding == enc::BGRA8) {
+                layout = {4, 8, true, true, enc::BGRA8};
+            } else if (enc::isBayer(encoding)) {
+                // the mosaic as it is, lossless only
+                const int bit_depth = enc::bitDepth(encoding);
+                layout = {1, bit_depth, false, false, bit_depth == 8 ? enc::MONO8 : enc::MONO16};
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        // -- JPEG
+
+        struct JpegError {
+            jpeg_error_mgr manager;
+            std::jmp_buf jump;
+            char message[JMSG_LENGTH_MAX];
+        };
+
+        void jpeg_error_exit(j_common_ptr cinfo) {
+            JpegError* error = reinterpret_cast<JpegError*>(cinfo->err);
+            (*cinfo->err->format_message)(cinfo, error->message);
+            std::longjmp(error->jump, 1);
+        }
+
+        // Destination writing into the data of the message, grown as needed
+        struct JpegDestination {
+            jpeg_destination_mgr manager;
+            std::vector<uint8_t>* data;
+        };
+
+        void jpeg_init_destination(j_compress_ptr cinfo) {
+            JpegDestination* dest = reinterpret_cast<JpegDestination*>(cinfo->dest);
+            // most images fit in a quarter of the raw size
+            dest->data->resize(std::max<size_t>(4096, cinfo->image_width * cinfo->image_height / 4));
+            dest->manager.next_output_byte = dest->data->data();
+            dest->manager.free_in_buffer = dest->data->size();
+        }
+
+        boolean jpeg_empty_output_buffer(j_compress_ptr cinfo) {
+            JpegDestination* dest = reinterpret_cast<JpegDestination*>(cinfo->dest);
+            // called with the buffer full, regardless of free_in_buffer
+            const size_t used = dest->data->size();
+            dest->data->resize(used * 2);
+            dest->manager.next_output_byte = dest->data->data() + used;
+            dest->manager.free_in_buffer = dest->data->size() - used;
+            return TRUE;
+        }
+
+        void jpeg_term_destination(j_compress_ptr cinfo) {
+            JpegDestination* dest = reinterpret_cast<JpegDestination*>(cinfo->dest);
+            dest->data->resize(dest->data->size() - dest->manager.free_in_buffer);
+        }
+
+        bool compress_jpeg(const sensor_msgs::Image& image, const Layout& layout, int quality,
+                           std::vector<uint8_t>& data, std::string& error) {
+            if (layout.bit_depth != 8 || (layout.n_channels == 1 && enc::isBayer(image.encoding))) {
+                error = "JPEG does not support " + image.encoding;
+                return false;
+            }
+
+            jpeg_compress_struct cinfo;
+            JpegError jpeg_error;
+            cinfo.err = jpeg_std_error(&jpeg_error.manager);
+            jpeg_error.manager.error_exit = jpeg_error_exit;
+            if (setjmp(jpeg_error.jump)) {
+                jpeg_destroy_compress(&cinfo);
+                error = jpeg_error.message;
+                return false;
+            }
+            jpeg_create_compress(&cinfo);
+
+            JpegDestination dest;
+            dest.manager.init_destination = jpeg_init_destination;
+            dest.manager.empty_output_buffer = jpeg_empty_output_buffer;
+            dest.manager.term_destination = jpeg_term_destination;
+            dest.data = &data;
+            cinfo.dest = &dest.manager;
+
+            cinfo.image_width = image.width;
+            cinfo.image_height = image.height;
+            cinfo.input_components = layout.n_channels;
+            switch (layout.n_channels) {
+                case 1: cinfo.in_color_space = JCS_GRAYSCALE; break;
+                case 3: cinfo.in_color_space = layout.bgr ? JCS_EXT_BGR : JCS_RGB; break;
+                default: cinfo.in_color_space = layout.bgr ? JCS_EXT_BGRX : JCS_EXT_RGBX; break;
+            }
+            jpeg_set_defaults(&cinfo);
+            jpeg_set_quality(&cinfo, quality, TRUE);
+            cinfo.dct_method = JDCT_IFAST;
+
+            jpeg_start_compress(&cinfo, TRUE);
+            while (cinfo.next_scanline < cinfo.image_height) {
+                JSAMPROW row = const_cast<JSAMPROW>(image.data.data() + cinfo.next_scanline * image.step);
+                jpeg_write_scanlines(&cinfo, &row, 1);
+            }
+            jpeg_finish_compress(&cinfo);
+            jpeg_destroy_compress(&cinfo);
+            return true;
+        }
+
+        // -- PNG
+
+        void png_write_data(png_structp png, png_bytep bytes, png_size_t n_bytes) {
+            std::vector<uint8_t>* data = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png));
+            data->insert(data->end(), bytes, bytes + n_bytes);
+        }
+
+        void png_flush_data(png_structp) {}
+
+        void png_error_exit(png_structp png, png_const_charp message) {
+            std::string* error = static_cast<std::string*>(png_get_error_ptr(png));
+            *error = message;
+            png_longjmp(png, 1);
+        }
+
+        bool compress_png(const sensor_msgs::Image& image, const Layout& layout, int level, std::vector<uint8_t>& data,
+                          std::string& error) {
+            png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, &error, png_error_exit, nullptr);
+            png_infop info = png ? png_create_info_struct(png) : nullptr;
+            if (!info) {
+                png_destroy_write_struct(&png, nullptr);
+                error = "cannot create PNG encoder";
+                return false;
+            }
+
+            std::vector<png_bytep> rows(image.height);
+            if (setjmp(png_jmpbuf(png))) {
+                png_destroy_write_struct(&png, &info);
+                return false;
+            }
+
+            data.clear();
+            data.reserve(image.data.size() / 2);
+            png_set_write_fn(png, &data, png_write_data, png_flush_data);
+            png_set_compression_level(png, level);
+            // at the fast levels the adaptive filter search costs more time than it saves bytes
+            png_set_filter(png, PNG_FILTER_TYPE_BASE, level <= 3 ? PNG_FILTER_SUB : PNG_ALL_FILTERS);
+
+            const int color_type = layout.n_channels == 1   ? PNG_COLOR_TYPE_GRAY
+                                   : layout.n_channels == 3 ? PNG_COLOR_TYPE_RGB
+                                                            : PNG_COLOR_TYPE_RGB_ALPHA;
+            png_set_IHDR(png, info, image.width, image.height, layout.bit_depth, color_type, PNG_INTERLACE_NONE,
+                         PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+            png_write_info(png, info);
+            if (layout.bgr) { png_set_bgr(png); }
+            // PNG stores big endian samples
+            if (layout.bit_depth == 16 && !image.is_bigendian) { png_set_swap(png); }
+
+            for (uint32_t y = 0; y < image.height; ++y) {
+                rows[y] = const_cast<png_bytep>(image.data.data() + y * image.step);
+            }
+            png_write_image(png, rows.data());
+            png_write_end(png, nullptr);
+            png_destroy_write_struct(&png, &info);
+            return true;
+        }
+    }  // namespace
+
+    bool compressImage(const sensor_msgs::Image& image, const CompressionOptions& options,
+                       sensor_msgs::CompressedImage& compressed, std::string& error) {
+        if (options.format == CompressionOptions::RAW12) {
+            if (!encodeRaw12(image, compressed.data, error)) { return false; }
+            compressed.header = image.header;
+            compressed.format = image.encoding + "; raw12 compressed";
+            return true;
+        }
+
+        Layout layout;
+        if (!get_layout(image.encoding, layout)) {
+            error = "unsupported encoding " + image.encoding;
+            return false;
+        }
+        if (image.step * image.height > image.data.size() ||
+            image.step < image.width * layout.n_channels * layout.bit_depth / 8) {
+            error = "inconsistent image size";
+            return false;
+        }
+
+        const bool jpeg = options.format == CompressionOptions::JPEG;
+        const bool res = jpeg ? compress_jpeg(image, layout, options.jpeg_quality, compressed.data, error)
+                              : compress_png(image, layout, options.png_level, compressed.data, error);
+        if (!res) { return false; }
+
+        compressed.header = image.header;
+        // JPEG has no alpha channel
+        const std::string& decoded_encoding = jpeg && layout.alpha ? enc::BGR8 : layout.decoded_encoding;
+        compressed.format = image.encoding + (jpeg ? "; jpeg compressed " : "; png compressed ") + decoded_encoding;
+        return true;
+    }
+
+}  // namespace camera_aravis::internal
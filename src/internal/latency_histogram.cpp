@@ -0,0 +1,86 @@
+#include <camera_aravis_internal/latency_histogram.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace camera_aravis::internal {
+
+    LatencyHistogram::LatencyHistogram() {
+        for (auto& bucket : buckets_) { bucket.store(0, std::memory_order_relaxed); }
+    }
+
+    size_t LatencyHistogram::bucket_index(uint64_t value_ns) {
+        if (value_ns < SUB_BUCKETS) return value_ns;
+
+        unsigned exponent = 63 - __builtin_clzll(value_ns);
+        if (exponent > MAX_EXPONENT) return N_BUCKETS - 1;
+
+        const unsigned shift = exponent - SUB_BUCKET_BITS;
+        const uint64_t mantissa = (value_ns >> shift) - SUB_BUCKETS;
+        return SUB_BUCKETS + shift * SUB_BUCKETS + mantissa;
+    }
+
+    uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+        if (index < SUB_BUCKETS) return index;
+
+        const uint64_t shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        const uint64_t mantissa = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        return ((SUB_BUCKETS + mantissa + 1) << shift) - 1;
+    }
+
+    void LatencyHistogram::record(uint64_t value_ns) {
+        buckets_[bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add(value_ns, std::memory_order_relaxed);
+
+        uint64_t max = max_ns_.load(std::memory_order_relaxed);
+        while (value_ns > max && !max_ns_.compare_exchange_weak(max, value_ns, std::memory_order_relaxed)) {}
+    }
+
+    LatencyHistogram::Snapshot LatencyHistogram::collect(bool reset) {
+        Snapshot res;
+        res.buckets.resize(N_BUCKETS);
+
+        uint64_t sum_ns = 0;
+        if (reset) {
+            for (size_t i = 0; i < N_BUCKETS; ++i) {
+                res.buckets[i] = buckets_[i].exchange(0, std::memory_order_relaxed);
+            }
+            sum_ns = sum_ns_.exchange(0, std::memory_order_relaxed);
+            res.max_ns = max_ns_.exchange(0, std::memory_order_relaxed);
+        } else {
+            for (size_t i = 0; i < N_BUCKETS; ++i) { res.buckets[i] = buckets_[i].load(std::memory_order_relaxed); }
+            sum_ns = sum_ns_.load(std::memory_order_relaxed);
+            res.max_ns = max_ns_.load(std::memory_order_relaxed);
+        }
+
+        // count from the copied buckets, so that quantiles stay consistent under concurrent recording
+        for (uint64_t n : res.buckets) { res.count += n; }
+        res.mean_ns = res.count > 0 ? static_cast<double>(sum_ns) / res.count : 0.0;
+        return res;
+    }
+
+    uint64_t LatencyHistogram::Snapshot::quantile_ns(double q) const {
+        if (count == 0) return 0;
+
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * count)));
+        uint64_t n = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            n += buckets[i];
+            if (n >= rank) return std::min(bucket_upper_bound(i), max_ns);
+        }
+        return max_ns;
+    }
+
+    const char* FrameLatency::stage_name(Stage stage) {
+        switch (stage) {
+            case TRANSFER: return "Transfer";
+            case DISPATCH: return "Dispatch";
+            case PREPARATION: return "Preparation";
+            case CONVERSION: return "Conversion";
+            case PUBLISH: return "Publish";
+            case TOTAL: return "Total";
+            default: return "Unknown";
+        }
+    }
+
+}  // namespace camera_aravis::internal
@@ -0,0 +1,120 @@
+#include <camera_aravis_internal/parallel_compressor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include <ros/console.h>
+
+#include <camera_aravis_internal/trace.h>
+
+namespace camera_aravis::internal {
+
+    ParallelCompressor::ParallelCompressor(const Config& config, Callback callback):
+        config_(config), callback_(std::move(callback)) {
+        const size_t n_threads = std::max<size_t>(1, config_.n_threads);
+        for (size_t i = 0; i < n_threads; ++i) { workers_.emplace_back(&ParallelCompressor::spin, this); }
+    }
+
+    ParallelCompressor::~ParallelCompressor() { stop(); }
+
+    bool ParallelCompressor::submit(const sensor_msgs::ImageConstPtr& image) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) { return false; }
+            ++statistics_.n_submitted;
+            if (statistics_.n_in_flight >= std::max<size_t>(1, config_.max_in_flight)) {
+                ++statistics_.n_dropped;
+                return false;
+            }
+            ++statistics_.n_in_flight;
+            queue_.push_back(Job{next_sequence_++, image});
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    void ParallelCompressor::stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+        for (std::thread& worker : workers_) {
+            if (worker.joinable()) { worker.join(); }
+        }
+        workers_.clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+        done_.clear();
+        statistics_.n_in_flight = 0;
+    }
+
+    ParallelCompressor::Statistics ParallelCompressor::get_statistics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return statistics_;
+    }
+
+    void ParallelCompressor::spin() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (!running_) { return; }
+
+            Job job = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+
+            sensor_msgs::CompressedImagePtr compressed = boost::make_shared<sensor_msgs::CompressedImage>();
+            std::string error;
+            const auto start = std::chrono::steady_clock::now();
+            bool res;
+            {
+                CA_TRACE_SCOPE("compress image");
+                res = compressImage(*job.image, config_.options, *compressed, error);
+            }
+            const uint64_t duration_ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            compression_time_.record(duration_ns);
+            const uint64_t n_bytes_raw = static_cast<uint64_t>(job.image->step) * job.image->height;
+            job.image.reset();
+            if (!res) {
+                ROS_WARN_THROTTLE(5.0, "camera_aravis: cannot compress image: %s", error.c_str());
+                compressed.reset();
+            }
+
+            lock.lock();
+            if (res) {
+                ++statistics_.n_compressed;
+                statistics_.n_bytes_raw += n_bytes_raw;
+                statistics_.n_bytes_compressed += compressed->data.size();
+                statistics_.compression_ns += duration_ns;
+            } else {
+                ++statistics_.n_failed;
+            }
+            done_.emplace(job.sequence, std::move(compressed));
+
+            // a single worker hands out whatever is complete in order, the others go back to compressing
+            if (delivering_) { continue; }
+            delivering_ = true;
+            while (running_ && !done_.empty() && done_.begin()->first == next_output_) {
+                sensor_msgs::CompressedImagePtr next = std::move(done_.begin()->second);
+                done_.erase(done_.begin());
+                ++next_output_;
+                --statistics_.n_in_flight;
+                if (!next) { continue; }
+
+                lock.unlock();
+                try {
+                    callback_(next);
+                } catch (const std::exception& e) {
+                    ROS_ERROR("camera_aravis: publishing a compressed image failed: %s", e.what());
+                }
+                lock.lock();
+            }
+            delivering_ = false;
+        }
+    }
+
+}  // namespace camera_aravis::internal
@@ -0,0 +1,148 @@
+#include <camera_aravis_internal/preview_binning.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <sensor_msgs/image_encodings.h>
+
+namespace camera_aravis::internal {
+
+    namespace {
+        // keeps the sums of 16 bit samples exact in the rounding division
+        constexpr uint32_t MAX_FACTOR = 32;
+
+        // acc[i] += row[i]
+        void accumulate(const uint8_t* row, uint32_t* acc, size_t n) {
+            size_t i = 0;
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= n; i += 16) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                const __m128i lo = _mm_unpacklo_epi8(v, zero);
+                const __m128i hi = _mm_unpackhi_epi8(v, zero);
+                __m128i* a = reinterpret_cast<__m128i*>(acc + i);
+                _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), _mm_unpacklo_epi16(lo, zero)));
+                _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), _mm_unpackhi_epi16(lo, zero)));
+                _mm_storeu_si128(a + 2, _mm_add_epi32(_mm_loadu_si128(a + 2), _mm_unpacklo_epi16(hi, zero)));
+                _mm_storeu_si128(a + 3, _mm_add_epi32(_mm_loadu_si128(a + 3), _mm_unpackhi_epi16(hi, zero)));
+            }
+#elif defined(__ARM_NEON)
+            for (; i + 16 <= n; i += 16) {
+                const uint8x16_t v = vld1q_u8(row + i);
+                const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+                const uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+                vst1q_u32(acc + i, vaddw_u16(vld1q_u32(acc + i), vget_low_u16(lo)));
+                vst1q_u32(acc + i + 4, vaddw_u16(vld1q_u32(acc + i + 4), vget_high_u16(lo)));
+                vst1q_u32(acc + i + 8, vaddw_u16(vld1q_u32(acc + i + 8), vget_low_u16(hi)));
+                vst1q_u32(acc + i + 12, vaddw_u16(vld1q_u32(acc + i + 12), vget_high_u16(hi)));
+            }
+#endif
+            for (; i < n; ++i) { acc[i] += row[i]; }
+        }
+
+        void accumulate(const uint16_t* row, uint32_t* acc, size_t n) {
+            size_t i = 0;
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= n; i += 8) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                __m128i* a = reinterpret_cast<__m128i*>(acc + i);
+                _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), _mm_unpacklo_epi16(v, zero)));
+                _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), _mm_unpackhi_epi16(v, zero)));
+            }
+#elif defined(__ARM_NEON)
+            for (; i + 8 <= n; i += 8) {
+                const uint16x8_t v = vld1q_u16(row + i);
+                vst1q_u32(acc + i, vaddw_u16(vld1q_u32(acc + i), vget_low_u16(v)));
+                vst1q_u32(acc + i + 4, vaddw_u16(vld1q_u32(acc + i + 4), vget_high_u16(v)));
+            }
+#endif
+            for (; i < n; ++i) { acc[i] += row[i]; }
+        }
+
+        template<typename T>
+        void bin(const sensor_msgs::Image& image, uint32_t factor, uint32_t span, uint32_t n_channels,
+                 sensor_msgs::Image& binned) {
+            const uint32_t block = span * factor;
+            const uint32_t n = factor * factor;
+            // (sum + n / 2) / n by a multiplication, exact for sums below 2^40 / n
+            const uint64_t reciprocal = ((uint64_t(1) << 40) + n - 1) / n;
+            // only the columns of complete blocks
+            const size_t n_samples = static_cast<size_t>(binned.width / span) * block * n_channels;
+
+            // previews run on the stream threads, which keep their accumulator
+            thread_local std::vector<uint32_t> acc;
+            acc.resize(n_samples);
+
+            for (uint32_t oy = 0; oy < binned.height; ++oy) {
+                // same color rows are span apart
+                const uint32_t y0 = oy / span * block + oy % span;
+                std::fill(acc.begin(), acc.end(), 0);
+                for (uint32_t j = 0; j < factor; ++j) {
+                    const uint8_t* row = image.data.data() + static_cast<size_t>(y0 + j * span) * image.step;
+                    accumulate(reinterpret_cast<const T*>(row), acc.data(), n_samples);
+                }
+
+                T* to = reinterpret_cast<T*>(binned.data.data() + static_cast<size_t>(oy) * binned.step);
+                for (uint32_t ox = 0; ox < binned.width; ++ox) {
+                    const uint32_t x0 = ox / span * block + ox % span;
+                    for (uint32_t c = 0; c < n_channels; ++c) {
+                        uint32_t sum = 0;
+                        for (uint32_t i = 0; i < factor; ++i) { sum += acc[(x0 + i * span) * n_channels + c]; }
+                        *to++ = static_cast<T>(((sum + n / 2) * reciprocal) >> 40);
+                    }
+                }
+            }
+        }
+    }  // namespace
+
+    bool binImage(const sensor_msgs::Image& image, uint32_t factor, sensor_msgs::Image& binned, std::string& error) {
+        namespace enc = sensor_msgs::image_encodings;
+        const bool bayer = enc::isBayer(image.encoding);
+        if (!bayer && !enc::isMono(image.encoding) && !enc::isColor(image.encoding)) {
+            error = "cannot bin " + image.encoding;
+            return false;
+        }
+        const int bit_depth = enc::bitDepth(image.encoding);
+        const uint32_t n_channels = enc::numChannels(image.encoding);
+        if (factor == 0 || factor > MAX_FACTOR || (bit_depth != 8 && bit_depth != 16)) {
+            error = "cannot bin " + image.encoding + " by " + std::to_string(factor);
+            return false;
+        }
+        if (image.step < image.width * n_channels * bit_depth / 8 ||
+            static_cast<size_t>(image.step) * image.height > image.data.size()) {
+            error = "inconsistent image size";
+            return false;
+        }
+
+        // distance of samples of the same color
+        const uint32_t span = bayer ? 2 : 1;
+        const uint32_t block = span * factor;
+        binned.header = image.header;
+        binned.width = image.width / block * span;
+        binned.height = image.height / block * span;
+        binned.encoding = image.encoding;
+        binned.is_bigendian = image.is_bigendian;
+        binned.step = binned.width * n_channels * bit_depth / 8;
+        binned.data.resize(static_cast<size_t>(binned.step) * binned.height);
+        if (binned.width == 0 || binned.height == 0) {
+            error = "image smaller than a block";
+            return false;
+        }
+
+        if (bit_depth == 8) {
+            bin<uint8_t>(image, factor, span, n_channels, binned);
+        } else {
+            bin<uint16_t>(image, factor, span, n_channels, binned);
+        }
+        return true;
+    }
+
+}  // namespace camera_aravis::internal
@@ -0,0 +1,161 @@
+#include <camera_aravis_internal/serialized_image_publisher.h>
+
+#include <mutex>
+#include <vector>
+
+#include <boost/shared_array.hpp>
+#include <ros/serialization.h>
+
+#include <camera_aravis_internal/trace.h>
+
+namespace camera_aravis::internal {
+
+    // An image message serialized into a pooled buffer, length prefix included
+    struct SerializedImage {
+        boost::shared_array<uint8_t> buffer;
+        uint32_t n_bytes = 0;
+    };
+
+}  // namespace camera_aravis::internal
+
+namespace ros {
+
+    namespace message_traits {
+        // on the wire a sensor_msgs/Image
+        template<>
+        struct MD5Sum<camera_aravis::internal::SerializedImage> {
+            static const char* value() { return MD5Sum<sensor_msgs::Image>::value(); }
+            static const char* value(const camera_aravis::internal::SerializedImage&) { return value(); }
+        };
+
+        template<>
+        struct DataType<camera_aravis::internal::SerializedImage> {
+            static const char* value() { return DataType<sensor_msgs::Image>::value(); }
+            static const char* value(const camera_aravis::internal::SerializedImage&) { return value(); }
+        };
+
+        template<>
+        struct Definition<camera_aravis::internal::SerializedImage> {
+            static const char* value() { return Definition<sensor_msgs::Image>::value(); }
+            static const char* value(const camera_aravis::internal::SerializedImage&) { return value(); }
+        };
+    }  // namespace message_traits
+
+    namespace serialization {
+        // hand the buffer to the subscriber connections as it is
+        template<>
+        inline SerializedMessage serializeMessage<camera_aravis::internal::SerializedImage>(
+            const camera_aravis::internal::SerializedImage& image) {
+            SerializedMessage res;
+            res.buf = image.buffer;
+            res.num_bytes = image.n_bytes;
+            res.message_start = image.buffer.get() + sizeof(uint32_t);
+            return res;
+        }
+    }  // namespace serialization
+
+}  // namespace ros
+
+namespace camera_aravis::internal {
+
+    class SerializedImagePublisher::Pool : public std::enable_shared_from_this<Pool> {
+        public:
+        boost::shared_array<uint8_t> acquire(size_t n_bytes) {
+            Buffer buffer;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++n_used_;
+                if (!available_.empty()) {
+                    buffer = std::move(available_.back());
+                    available_.pop_back();
+                }
+            }
+
+            // the image size changed, the old buffers go as they come back
+            if (buffer.capacity < n_bytes) {
+                CA_TRACE_INSTANT("allocate serialized image");
+                buffer.data.reset(new uint8_t[n_bytes]);
+                buffer.capacity = n_bytes;
+            }
+
+            uint8_t* data = buffer.data.release();
+            return boost::shared_array<uint8_t>(data, Release{weak_from_this(), buffer.capacity});
+        }
+
+        size_t getAllocatedSize() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return n_used_ + available_.size();
+        }
+
+        size_t getUsedSize() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return n_used_;
+        }
+
+        private:
+        struct Buffer {
+            std::unique_ptr<uint8_t[]> data;
+            size_t capacity = 0;
+        };
+
+        // Deleter of the shared buffers, called once the last subscriber connection sent it
+        struct Release {
+            std::weak_ptr<Pool> pool;
+            size_t capacity;
+
+            void operator()(uint8_t* data) const {
+                std::unique_ptr<uint8_t[]> owned(data);
+                if (std::shared_ptr<Pool> p = pool.lock()) { p->release(std::move(owned), capacity); }
+            }
+        };
+
+        void release(std::unique_ptr<uint8_t[]> data, size_t capacity) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --n_used_;
+            available_.push_back(Buffer{std::move(data), capacity});
+        }
+
+        mutable std::mutex mutex_;
+        std::vector<Buffer> available_;
+        size_t n_used_ = 0;
+    };
+
+    SerializedImagePublisher::SerializedImagePublisher(ros::NodeHandle& nh, const std::string& topic):
+        pool_(std::make_shared<Pool>()), subscribers_(std::make_shared<Subscribers>()) {
+        // connections of subscribers in this process are intra-process links, they carry our node name
+        std::shared_ptr<Subscribers> subscribers = subscribers_;
+        auto count = [subscribers](const ros::SingleSubscriberPublisher& ssp, int delta) {
+            std::atomic<uint32_t>& n = ssp.getSubscriberName() == ros::this_node::getName() ? subscribers->n_local
+                                                                                             : subscribers->n_remote;
+            n += delta;
+        };
+        publisher_ = nh.advertise<SerializedImage>(
+            topic, 1, [count](const ros::SingleSubscriberPublisher& ssp) { count(ssp, 1); },
+            [count](const ros::SingleSubscriberPublisher& ssp) { count(ssp, -1); });
+    }
+
+    SerializedImagePublisher::~SerializedImagePublisher() { publisher_.shutdown(); }
+
+    void SerializedImagePublisher::publish(const sensor_msgs::Image& image) {
+        CA_TRACE_SCOPE("serialize image");
+        const uint32_t n_bytes_message = ros::serialization::serializationLength(image);
+        const uint32_t n_bytes = n_bytes_message + sizeof(uint32_t);
+
+        boost::shared_ptr<SerializedImage> message = boost::make_shared<SerializedImage>();
+        message->buffer = pool_->acquire(n_bytes);
+        message->n_bytes = n_bytes;
+
+        ros::serialization::OStream stream(message->buffer.get(), n_bytes);
+        stream.next(n_bytes_message);
+        ros::serialization::serialize(stream, image);
+
+        publisher_.publish(message);
+    }
+
+    uint32_t SerializedImagePublisher::getNumLocalSubscribers() const { return subscribers_->n_local; }
+    uint32_t SerializedImagePublisher::getNumRemoteSubscribers() const { return subscribers_->n_remote; }
+
+    size_t SerializedImagePublisher::getAllocatedSize() const { return pool_->getAllocatedSize(); }
+    size_t SerializedImagePublisher::getUsedSize() const { return pool_->getUsedSize(); }
+
+}  // namespace camera_aravis::internal
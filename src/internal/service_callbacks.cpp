@@ -3,13 +3,17 @@
 #include <camera_aravis_internal/GErrorGuard.h>
 #include <camera_aravis_internal/GErrorROSLog.h>
 #include <camera_aravis_internal/aravis_abstraction.h>
+#include <camera_aravis_internal/control_executor.h>
+#include <camera_aravis_internal/feature_value_cache.h>
+#include <camera_aravis_internal/trace.h>
 
 namespace camera_aravis {
     bool CameraAravisNodelet::getIntegerFeatureCallback(camera_aravis::get_integer_feature_value::Request& request,
                                                         camera_aravis::get_integer_feature_value::Response& response) {
         GuardedGError error;
         const char* feature_name = request.feature.c_str();
-        response.response = arv_device_get_integer_feature_value(this->device.get(), feature_name, error.storeError());
+        response.response = control(internal::ControlExecutor::SERVICE,
+                                    [&]() { return feature_cache_->read_integer(feature_name, error); });
         LOG_GERROR_ARAVIS(error);
         return !error;
     }
@@ -20,7 +24,7 @@ namespace camera_aravis {
         const char* feature_name = request.feature.c_str();
         guint64 value = request.value;
         ROS_INFO_STREAM("Camera aravis: setting " << feature_name << " = " << value);
-        arv_device_set_integer_feature_value(this->device.get(), feature_name, value, error.storeError());
+        control(internal::ControlExecutor::SERVICE, [&]() { feature_cache_->set_integer(feature_name, value, error); });
         LOG_GERROR_ARAVIS(error);
         response.ok = !error;
         return true;
@@ -30,7 +34,8 @@ namespace camera_aravis {
                                                       camera_aravis::get_float_feature_value::Response& response) {
         GuardedGError error;
         const char* feature_name = request.feature.c_str();
-        response.response = arv_device_get_float_feature_value(this->device.get(), feature_name, error.storeError());
+        response.response = control(internal::ControlExecutor::SERVICE,
+                                    [&]() { return feature_cache_->read_float(feature_name, error); });
         LOG_GERROR_ARAVIS(error);
         return !error;
     }
@@ -41,7 +46,7 @@ namespace camera_aravis {
         const char* feature_name = request.feature.c_str();
         const double value = request.value;
         ROS_INFO_STREAM("Camera aravis: setting " << feature_name << " = " << value);
-        arv_device_set_float_feature_value(this->device.get(), feature_name, value, error.storeError());
+        control(internal::ControlExecutor::SERVICE, [&]() { feature_cache_->set_float(feature_name, value, error); });
         LOG_GERROR_ARAVIS(error);
         response.ok = !error;
         return true;
@@ -51,7 +56,8 @@ namespace camera_aravis {
                                                        camera_aravis::get_string_feature_value::Response& response) {
         GuardedGError error;
         const char* feature_name = request.feature.c_str();
-        response.response = arv_device_get_string_feature_value(this->device.get(), feature_name, error.storeError());
+        response.response = control(internal::ControlExecutor::SERVICE,
+                                    [&]() { return feature_cache_->read_string(feature_name, error); });
         LOG_GERROR_ARAVIS(error);
         return !error;
     }
@@ -62,7 +68,7 @@ namespace camera_aravis {
         const char* feature_name = request.feature.c_str();
         const char* value = request.value.c_str();
         ROS_INFO_STREAM("Camera aravis: setting " << feature_name << " = " << value);
-        arv_device_set_string_feature_value(this->device.get(), feature_name, value, error.storeError());
+        control(internal::ControlExecutor::SERVICE, [&]() { feature_cache_->set_string(feature_name, value, error); });
         LOG_GERROR_ARAVIS(error);
         response.ok = !error;
         return true;
@@ -72,7 +78,8 @@ namespace camera_aravis {
                                                         camera_aravis::get_boolean_feature_value::Response& response) {
         GuardedGError error;
         const char* feature_name = request.feature.c_str();
-        response.response = arv_device_get_boolean_feature_value(this->device.get(), feature_name, error.storeError());
+        response.response = control(internal::ControlExecutor::SERVICE,
+                                    [&]() { return feature_cache_->read_boolean(feature_name, error); });
         LOG_GERROR_ARAVIS(error);
         return !error;
     }
@@ -83,7 +90,7 @@ namespace camera_aravis {
         const char* feature_name = request.feature.c_str();
         const bool value = request.value;
         ROS_INFO_STREAM("Camera aravis: setting " << feature_name << " = " << value);
-        arv_device_set_boolean_feature_value(this->device.get(), feature_name, value, error.storeError());
+        control(internal::ControlExecutor::SERVICE, [&]() { feature_cache_->set_boolean(feature_name, value, error); });
         LOG_GERROR_ARAVIS(error);
         response.ok = !error;
         return true;
@@ -93,9 +100,107 @@ namespace camera_aravis {
                                                      camera_aravis::execute_command::Response& response) {
         GuardedGError error;
         const char* command = request.command.c_str();
-        arv_device_execute_command(this->device.get(), command, error.storeError());
+        control(internal::ControlExecutor::SERVICE, [&]() { feature_cache_->execute_command(command, error); });
         LOG_GERROR_ARAVIS(error);
         response.response = !error;
         return true;
     }
+
+    bool CameraAravisNodelet::getFeaturesCallback(camera_aravis::get_features::Request& request,
+                                                  camera_aravis::get_features::Response& response) {
+        response.features = request.features;
+        response.ok.assign(response.features.size(), false);
+
+        // the whole batch is a single request, so the device is locked only once
+        control(internal::ControlExecutor::SERVICE, [&]() {
+            const auto lock = feature_cache_->lock();
+            for (size_t i = 0; i < response.features.size(); ++i) {
+                GuardedGError error;
+                FeatureValue& item = response.features[i];
+                const char* feature_name = item.feature.c_str();
+                switch (item.type) {
+                    case FeatureValue::INTEGER:
+                        item.integer_value = feature_cache_->read_integer(feature_name, error);
+                        break;
+                    case FeatureValue::FLOAT:
+                        item.float_value = feature_cache_->read_float(feature_name, error);
+                        break;
+                    case FeatureValue::STRING:
+                        item.string_value = feature_cache_->read_string(feature_name, error);
+                        break;
+                    case FeatureValue::BOOLEAN:
+                        item.boolean_value = feature_cache_->read_boolean(feature_name, error);
+                        break;
+                    default:
+                        ROS_WARN("Camera aravis: unknown type %u of feature %s", item.type, feature_name);
+                        continue;
+                }
+                LOG_GERROR_ARAVIS(error);
+                response.ok[i] = !error;
+            }
+        });
+        return true;
+    }
+
+    bool CameraAravisNodelet::setFeaturesCallback(camera_aravis::set_features::Request& request,
+                                                  camera_aravis::set_features::Response& response) {
+        response.ok.assign(request.features.size(), false);
+
+        // the whole batch is a single request, so the device is locked only once
+        control(internal::ControlExecutor::SERVICE, [&]() {
+            const auto lock = feature_cache_->lock();
+            for (size_t i = 0; i < request.features.size(); ++i) {
+                GuardedGError error;
+                const FeatureValue& item = request.features[i];
+                const char* feature_name = item.feature.c_str();
+                switch (item.type) {
+                    case FeatureValue::INTEGER:
+                        ROS_INFO_STREAM("Camera aravis: setting " << feature_name << " = " << item.integer_value);
+                        feature_cache_->set_integer(feature_name, item.integer_value, error);
+                        break;
+                    case FeatureValue::FLOAT:
+                        ROS_INFO_STREAM("Camera aravis: setting " << feature_name << " = " << item.float_value);
+                        feature_cache_->set_float(feature_name, item.float_value, error);
+                        break;
+                    case FeatureValue::STRING:
+                        ROS_INFO_STREAM("Camera aravis: setting " << feature_name << " = " << item.string_value);
+                        feature_cache_->set_string(feature_name, item.string_value.c_str(), error);
+                        break;
+                    case FeatureValue::BOOLEAN:
+                        ROS_INFO_STREAM("Camera aravis: setting " << feature_name << " = " << bool(item.boolean_value));
+                        feature_cache_->set_boolean(feature_name, item.boolean_value, error);
+                        break;
+                    default:
+                        ROS_WARN("Camera aravis: unknown type %u of feature %s", item.type, feature_name);
+                        continue;
+                }
+                LOG_GERROR_ARAVIS(error);
+                response.ok[i] = !error;
+            }
+        });
+        return true;
+    }
+
+    bool CameraAravisNodelet::writeTraceCallback(camera_aravis::write_trace::Request& request,
+                                                 camera_aravis::write_trace::Response& response) {
+#ifdef CAMERA_ARAVIS_ENABLE_TRACING
+        const std::string path = request.path.empty() ? trace_file_ : request.path;
+        if (path.empty()) {
+            ROS_WARN("Camera aravis: no path given and trace_file is not set");
+            response.response = false;
+            return true;
+        }
+
+        response.response = internal::trace::write_chrome_trace(path);
+        if (response.response) {
+            ROS_INFO("Camera aravis: trace written to %s", path.c_str());
+        } else {
+            ROS_ERROR("Camera aravis: failed to write trace to %s", path.c_str());
+        }
+#else
+        ROS_WARN("Camera aravis: built without CAMERA_ARAVIS_ENABLE_TRACING");
+        response.response = false;
+#endif
+        return true;
+    }
 }  // namespace camera_aravis
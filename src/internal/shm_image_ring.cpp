@@ -0,0 +1,217 @@
+#include <camera_aravis_internal/shm_image_ring.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace camera_aravis::internal {
+
+    namespace {
+        constexpr uint32_t MAGIC = 0x43415348;  // "CASH"
+        constexpr uint32_t VERSION = 1;
+        // set in the slot state while the writer owns it, the lower bits count the readers
+        constexpr uint32_t WRITING = 0x80000000u;
+
+        size_t page_size() { return static_cast<size_t>(sysconf(_SC_PAGESIZE)); }
+        size_t round_up(size_t n, size_t alignment) { return (n + alignment - 1) / alignment * alignment; }
+
+        std::string errno_string(const char* call) { return std::string(call) + ": " + std::strerror(errno); }
+    }  // namespace
+
+    struct alignas(64) ShmImageRing::Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t generation;
+        uint32_t n_slots;
+        uint32_t reserved;
+        uint64_t slot_size;    // rounded up to pages
+        uint64_t header_size;  // offset of the slot data, page aligned
+    };
+
+    struct alignas(64) ShmImageRing::SlotHeader {
+        std::atomic<uint32_t> state;
+        std::atomic<uint64_t> sequence;
+        uint64_t size;
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+                  "shared memory atomics must be lock free");
+
+    ShmImageRing::~ShmImageRing() {
+        if (header_) { munmap(header_, header_size_); }
+        if (data_) { munmap(data_, data_size_); }
+        if (writer_) { shm_unlink(name_.c_str()); }
+    }
+
+    std::string ShmImageRing::object_name(const std::string& topic) {
+        std::string res = "/camera_aravis";
+        for (char c : topic) { res += c == '/' ? '.' : c; }
+        return res;
+    }
+
+    std::unique_ptr<ShmImageRing> ShmImageRing::create(const std::string& name, uint32_t n_slots, size_t slot_size,
+                                                       mode_t mode, std::string& error) {
+        if (n_slots == 0 || slot_size == 0) {
+            error = "empty ring";
+            return nullptr;
+        }
+
+        const size_t header_size = round_up(sizeof(Header) + n_slots * sizeof(SlotHeader), page_size());
+        slot_size = round_up(slot_size, page_size());
+        const size_t total_size = header_size + n_slots * slot_size;
+
+        // readers still holding a stale object keep their mapping, new readers get the new one
+        shm_unlink(name.c_str());
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, mode);
+        if (fd < 0) {
+            error = errno_string("shm_open");
+            return nullptr;
+        }
+        // shm_open applies the umask, which would lock out the group of a group readable mode
+        if (fchmod(fd, mode) != 0) {
+            error = errno_string("fchmod");
+            close(fd);
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+        if (ftruncate(fd, total_size) != 0) {
+            error = errno_string("ftruncate");
+            close(fd);
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+
+        std::unique_ptr<ShmImageRing> res(new ShmImageRing());
+        res->name_ = name;
+        res->writer_ = true;
+        const bool mapped = res->map(fd, header_size, total_size, true, error);
+        close(fd);
+        if (!mapped) { return nullptr; }
+
+        // the object is zero filled, which is a valid initial state of the atomics
+        res->header_->magic = MAGIC;
+        res->header_->version = VERSION;
+        res->header_->generation = std::chrono::steady_clock::now().time_since_epoch().count() ^ getpid();
+        res->header_->n_slots = n_slots;
+        res->header_->slot_size = slot_size;
+        res->header_->header_size = header_size;
+        return res;
+    }
+
+    std::unique_ptr<ShmImageRing> ShmImageRing::open(const std::string& name, std::string& error) {
+        const int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            error = errno_string("shm_open");
+            return nullptr;
+        }
+
+        struct stat st;
+        Header header;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header) ||
+            pread(fd, &header, sizeof(header), 0) != sizeof(header)) {
+            error = "not a ring: " + name;
+            close(fd);
+            return nullptr;
+        }
+        if (header.magic != MAGIC || header.version != VERSION ||
+            header.header_size + header.n_slots * header.slot_size > static_cast<uint64_t>(st.st_size)) {
+            error = "incompatible ring: " + name;
+            close(fd);
+            return nullptr;
+        }
+
+        std::unique_ptr<ShmImageRing> res(new ShmImageRing());
+        res->name_ = name;
+        const bool mapped =
+            res->map(fd, header.header_size, header.header_size + header.n_slots * header.slot_size, false, error);
+        close(fd);
+        return mapped ? std::move(res) : nullptr;
+    }
+
+    bool ShmImageRing::map(int fd, size_t header_size, size_t total_size, bool writer, std::string& error) {
+        void* header = mmap(nullptr, header_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (header == MAP_FAILED) {
+            error = errno_string("mmap");
+            return false;
+        }
+        header_ = static_cast<Header*>(header);
+        header_size_ = header_size;
+
+        data_size_ = total_size - header_size;
+        void* data = mmap(nullptr, data_size_, writer ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd,
+                          static_cast<off_t>(header_size));
+        if (data == MAP_FAILED) {
+            error = errno_string("mmap");
+            return false;
+        }
+        data_ = static_cast<uint8_t*>(data);
+        return true;
+    }
+
+    uint64_t ShmImageRing::generation() const { return header_->generation; }
+    uint32_t ShmImageRing::n_slots() const { return header_->n_slots; }
+    size_t ShmImageRing::slot_size() const { return header_->slot_size; }
+
+    ShmImageRing::SlotHeader& ShmImageRing::slot_header(uint32_t slot) const {
+        return reinterpret_cast<SlotHeader*>(header_ + 1)[slot];
+    }
+
+    uint8_t* ShmImageRing::slot_data(uint32_t slot) const { return data_ + slot * header_->slot_size; }
+
+    ShmImageRing::Statistics ShmImageRing::get_statistics() const {
+        Statistics res;
+        res.n_written = n_written_;
+        res.n_full = n_full_;
+        return res;
+    }
+
+    bool ShmImageRing::write(const uint8_t* data, size_t size, uint32_t& slot, uint64_t& sequence) {
+        if (size > header_->slot_size) { return false; }
+
+        // oldest first, skipping slots which readers still hold
+        const uint32_t n_slots = header_->n_slots;
+        for (uint32_t i = 0; i < n_slots; ++i) {
+            const uint32_t candidate = (next_slot_ + i) % n_slots;
+            SlotHeader& slot_header = this->slot_header(candidate);
+            uint32_t idle = 0;
+            if (!slot_header.state.compare_exchange_strong(idle, WRITING, std::memory_order_acquire)) { continue; }
+
+            std::memcpy(slot_data(candidate), data, size);
+            slot_header.size = size;
+            sequence = ++n_written_;
+            slot_header.sequence.store(sequence, std::memory_order_relaxed);
+            slot_header.state.fetch_sub(WRITING, std::memory_order_release);
+
+            slot = candidate;
+            next_slot_ = (candidate + 1) % n_slots;
+            return true;
+        }
+
+        ++n_full_;
+        return false;
+    }
+
+    const uint8_t* ShmImageRing::acquire(uint32_t slot, uint64_t sequence, size_t& size) {
+        if (slot >= header_->n_slots) { return nullptr; }
+
+        // holding a reference keeps the writer out, then the slot must still have the requested contents
+        SlotHeader& slot_header = this->slot_header(slot);
+        const uint32_t state = slot_header.state.fetch_add(1, std::memory_order_acquire);
+        if ((state & WRITING) || slot_header.sequence.load(std::memory_order_relaxed) != sequence) {
+            slot_header.state.fetch_sub(1, std::memory_order_release);
+            return nullptr;
+        }
+        size = slot_header.size;
+        return slot_data(slot);
+    }
+
+    void ShmImageRing::release(uint32_t slot) {
+        if (slot < header_->n_slots) { slot_header(slot).state.fetch_sub(1, std::memory_order_release); }
+    }
+
+}  // namespace camera_aravis::internal
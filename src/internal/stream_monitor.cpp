@@ -0,0 +1,76 @@
+#include <camera_aravis_internal/stream_monitor.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace camera_aravis::internal {
+
+    namespace {
+        uint64_t delta(uint64_t current, uint64_t previous) { return current >= previous ? current - previous : 0; }
+    }  // namespace
+
+    StreamMonitor::StreamMonitor(): window_start_(std::chrono::steady_clock::now()) {}
+
+    void StreamMonitor::record_frame(uint64_t timestamp_ns, size_t n_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++n_frames_;
+        n_bytes_ += n_bytes;
+
+        if (last_timestamp_ns_ > 0 && timestamp_ns > last_timestamp_ns_) {
+            const double interval_s = (timestamp_ns - last_timestamp_ns_) * 1e-9;
+            ++n_intervals_;
+            const double d = interval_s - interval_mean_s_;
+            interval_mean_s_ += d / n_intervals_;
+            interval_m2_ += d * (interval_s - interval_mean_s_);
+            interval_max_s_ = std::max(interval_max_s_, interval_s);
+        }
+        last_timestamp_ns_ = timestamp_ns;
+    }
+
+    void StreamMonitor::record_cpu(const CpuTimes& cpu_ns) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++n_cpu_frames_;
+        for (size_t i = 0; i < N_CPU_STAGES; ++i) { cpu_ns_[i] += cpu_ns[i]; }
+    }
+
+    uint64_t StreamMonitor::Window::cpu_total_ns() const {
+        uint64_t res = 0;
+        for (uint64_t ns : cpu_ns) { res += ns; }
+        return res;
+    }
+
+    StreamMonitor::Window StreamMonitor::collect(const Counters& counters) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto now = std::chrono::steady_clock::now();
+
+        Window res;
+        res.duration_s = std::chrono::duration<double>(now - window_start_).count();
+        res.n_frames = n_frames_;
+        res.n_bytes = n_bytes_;
+        res.interval_mean_s = interval_mean_s_;
+        res.interval_stddev_s = n_intervals_ > 1 ? std::sqrt(interval_m2_ / (n_intervals_ - 1)) : 0.0;
+        res.interval_max_s = interval_max_s_;
+        res.n_cpu_frames = n_cpu_frames_;
+        res.cpu_ns = cpu_ns_;
+
+        res.delta.n_completed = delta(counters.n_completed, counters_.n_completed);
+        res.delta.n_failures = delta(counters.n_failures, counters_.n_failures);
+        res.delta.n_underruns = delta(counters.n_underruns, counters_.n_underruns);
+        res.delta.n_resent = delta(counters.n_resent, counters_.n_resent);
+        res.delta.n_missing = delta(counters.n_missing, counters_.n_missing);
+
+        // the last timestamp is kept, so that the interval across the window boundary is not lost
+        window_start_ = now;
+        counters_ = counters;
+        n_frames_ = 0;
+        n_bytes_ = 0;
+        n_intervals_ = 0;
+        interval_mean_s_ = 0.0;
+        interval_m2_ = 0.0;
+        interval_max_s_ = 0.0;
+        n_cpu_frames_ = 0;
+        cpu_ns_ = {};
+        return res;
+    }
+
+}  // namespace camera_aravis::internal
@@ -0,0 +1,152 @@
+#include <camera_aravis_internal/trace.h>
+
+#ifdef CAMERA_ARAVIS_ENABLE_TRACING
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace camera_aravis::internal::trace {
+
+    namespace {
+        enum Phase : char { COMPLETE = 'X', INSTANT = 'i', COUNTER = 'C' };
+
+        struct Event {
+            const char* name;
+            Phase phase;
+            uint64_t ts_ns;
+            uint64_t dur_ns;
+            int64_t value;
+        };
+
+        // Single producer ring buffer, only the owning thread writes
+        struct ThreadBuffer {
+            static constexpr uint64_t CAPACITY = 1 << 15;
+
+            long tid = 0;
+            std::string name;
+            std::atomic<uint64_t> head{0};
+            std::vector<Event> events = std::vector<Event>(CAPACITY);
+        };
+
+        std::mutex registry_mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> registry;
+
+        ThreadBuffer& get_thread_buffer() {
+            // kept alive by the registry, so that events of finished threads can still be exported
+            thread_local std::shared_ptr<ThreadBuffer> buffer = []() {
+                auto res = std::make_shared<ThreadBuffer>();
+                res->tid = syscall(SYS_gettid);
+                char name[16] = {0};
+                if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) { res->name = name; }
+
+                std::lock_guard<std::mutex> lock(registry_mutex);
+                registry.push_back(res);
+                return res;
+            }();
+            return *buffer;
+        }
+
+        void record(const Event& event) {
+            ThreadBuffer& buffer = get_thread_buffer();
+            const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+            buffer.events[head % ThreadBuffer::CAPACITY] = event;
+            buffer.head.store(head + 1, std::memory_order_release);
+        }
+
+        void write_string(std::ostream& out, const std::string& str) {
+            out << '"';
+            for (char c : str) {
+                if (c == '"' || c == '\\') {
+                    out << '\\' << c;
+                } else if (static_cast<unsigned char>(c) >= 0x20) {
+                    out << c;
+                }
+            }
+            out << '"';
+        }
+    }  // namespace
+
+    uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    void record_complete(const char* name, uint64_t begin_ns, uint64_t end_ns) {
+        record(Event{name, COMPLETE, begin_ns, end_ns - begin_ns, 0});
+    }
+
+    void record_instant(const char* name) { record(Event{name, INSTANT, now_ns(), 0, 0}); }
+
+    void record_counter(const char* name, int64_t value) { record(Event{name, COUNTER, now_ns(), 0, value}); }
+
+    bool write_chrome_trace(const std::string& path) {
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            buffers = registry;
+        }
+
+        std::ofstream out(path);
+        if (!out) { return false; }
+
+        const long pid = getpid();
+        bool first = true;
+        auto separator = [&]() {
+            if (!first) { out << ",\n"; }
+            first = false;
+        };
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        out.precision(3);
+        out << std::fixed;
+        for (const auto& buffer : buffers) {
+            separator();
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":";
+            write_string(out, buffer->name.empty() ? "thread " + std::to_string(buffer->tid) : buffer->name);
+            out << "}}";
+
+            const uint64_t head = buffer->head.load(std::memory_order_acquire);
+            const uint64_t begin = head > ThreadBuffer::CAPACITY ? head - ThreadBuffer::CAPACITY : 0;
+            std::vector<Event> events;
+            events.reserve(head - begin);
+            for (uint64_t i = begin; i < head; ++i) { events.push_back(buffer->events[i % ThreadBuffer::CAPACITY]); }
+
+            // drop what the owning thread may have overwritten while copying, including the slot of event new_head,
+            // which it may be writing right now (that of event new_head - CAPACITY)
+            const uint64_t new_head = buffer->head.load(std::memory_order_acquire);
+            const uint64_t valid_begin =
+                new_head >= ThreadBuffer::CAPACITY ? new_head - ThreadBuffer::CAPACITY + 1 : 0;
+
+            for (uint64_t i = std::max(begin, valid_begin); i < head; ++i) {
+                const Event& event = events[i - begin];
+                separator();
+                out << "{\"ph\":\"" << static_cast<char>(event.phase) << "\",\"name\":";
+                write_string(out, event.name);
+                out << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid << ",\"ts\":" << event.ts_ns * 1e-3;
+                switch (event.phase) {
+                    case COMPLETE: out << ",\"dur\":" << event.dur_ns * 1e-3; break;
+                    case INSTANT: out << ",\"s\":\"t\""; break;
+                    case COUNTER: out << ",\"args\":{\"value\":" << event.value << "}"; break;
+                }
+                out << "}";
+            }
+        }
+        out << "\n]}\n";
+
+        return static_cast<bool>(out);
+    }
+
+}  // namespace camera_aravis::internal::trace
+
+#endif
@@ -2,29 +2,68 @@
 #include <camera_aravis_internal/tuneGVStream.h>
 #include <ros/console.h>
 
-namespace camera_aravis::internal {
-    // Extra stream options for GigEVision streams.
-    void tuneGvStream(ArvGvStream* p_stream) {
-        gboolean b_auto_buffer = FALSE;
-        gboolean b_packet_resend = TRUE;
-        unsigned int timeout_packet = 40;  // milliseconds
-        unsigned int timeout_frame_retention = 200;
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
+namespace camera_aravis::internal {
+    void tuneGvStream(ArvGvStream* p_stream, const GvStreamOptions& options) {
         if (p_stream) {
             if (!ARV_IS_GV_STREAM(p_stream)) {
                 ROS_WARN("Stream is not a GV_STREAM");
                 return;
             }
 
-            if (b_auto_buffer)
+            if (options.auto_socket_buffer) {
                 g_object_set(p_stream, "socket-buffer", ARV_GV_STREAM_SOCKET_BUFFER_AUTO, "socket-buffer-size", 0,
                              NULL);
-            if (!b_packet_resend)
-                g_object_set(p_stream, "packet-resend",
-                             b_packet_resend ? ARV_GV_STREAM_PACKET_RESEND_ALWAYS : ARV_GV_STREAM_PACKET_RESEND_NEVER,
-                             NULL);
-            g_object_set(p_stream, "packet-timeout", timeout_packet * 1000, "frame-retention",
-                         timeout_frame_retention * 1000, NULL);
+            } else if (options.socket_buffer_size > 0) {
+                g_object_set(p_stream, "socket-buffer", ARV_GV_STREAM_SOCKET_BUFFER_FIXED, "socket-buffer-size",
+                             static_cast<gint>(options.socket_buffer_size), NULL);
+            }
+            g_object_set(p_stream, "packet-resend",
+                         options.packet_resend ? ARV_GV_STREAM_PACKET_RESEND_ALWAYS : ARV_GV_STREAM_PACKET_RESEND_NEVER,
+                         NULL);
+            g_object_set(p_stream, "packet-timeout", options.packet_timeout_ms * 1000, "frame-retention",
+                         options.frame_retention_ms * 1000, NULL);
+        }
+    }
+
+    gint negotiatePacketSize(const NonOwnedGPtr<ArvCamera>& cam, gint packet_size) {
+        if (packet_size > 0) {
+            aravis::camera::gv::set_packet_size(cam, packet_size);
+        } else {
+            aravis::camera::gv::auto_packet_size(cam);
         }
+
+        // the camera may round to its packet size increment
+        const gint res = aravis::camera::gv::get_packet_size(cam);
+        if (packet_size > 0 && res != packet_size) {
+            ROS_WARN("Requested packet size %d, camera uses %d", packet_size, res);
+        }
+        return res;
+    }
+
+    bool packetSocketAvailable() {
+#ifdef __linux__
+        const int fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_IP));
+        if (fd < 0) { return false; }
+        close(fd);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    guint64 packetsPerFrame(gint packet_size, gint64 n_bytes_payload) {
+        // IP (20), UDP (8) and GVSP (8) headers
+        const gint n_bytes_header = 36;
+        if (packet_size <= n_bytes_header || n_bytes_payload <= 0) { return 0; }
+
+        const guint64 n_bytes_data = packet_size - n_bytes_header;
+        return (n_bytes_payload + n_bytes_data - 1) / n_bytes_data + 2;
     }
 }
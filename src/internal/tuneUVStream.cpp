@@ -0,0 +1,33 @@
+
+#include <camera_aravis_internal/tuneUVStream.h>
+#include <ros/console.h>
+
+namespace camera_aravis::internal {
+    void tuneUvStream(const NonOwnedGPtr<ArvDevice>& dev, aravis::device::feature::ValueCache& features,
+                      const UvStreamOptions& options) {
+        if (!aravis::device::is_uv(dev)) { return; }
+
+        if (options.channel_packet_size > 0) {
+            if (aravis::device::feature::get_node(dev, "DeviceStreamChannelPacketSize")) {
+                features.set_integer("DeviceStreamChannelPacketSize", options.channel_packet_size);
+                ROS_INFO("USB stream channel packet size %" G_GINT64_FORMAT " bytes",
+                         features.get_integer("DeviceStreamChannelPacketSize"));
+            } else {
+                ROS_WARN("Camera has no DeviceStreamChannelPacketSize, keeping its transfer size");
+            }
+        }
+
+        if (options.throughput_limit > 0) {
+            if (aravis::device::feature::get_node(dev, "DeviceLinkThroughputLimit")) {
+                if (aravis::device::feature::get_node(dev, "DeviceLinkThroughputLimitMode")) {
+                    features.set_string("DeviceLinkThroughputLimitMode", "On");
+                }
+                features.set_integer("DeviceLinkThroughputLimit", options.throughput_limit);
+                ROS_INFO("USB link throughput limit %" G_GINT64_FORMAT " bytes/s",
+                         features.get_integer("DeviceLinkThroughputLimit"));
+            } else {
+                ROS_WARN("Camera has no DeviceLinkThroughputLimit, not limiting the link throughput");
+            }
+        }
+    }
+}  // namespace camera_aravis::internal
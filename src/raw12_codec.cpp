@@ -0,0 +1,407 @@
+/****************************************************************************
+ *
+ * camera_aravis
+ *
+ * Copyright © 2022 Fraunhofer IOSB and contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+
+
+#include <camera_aravis/raw12_codec.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <sensor_msgs/image_encodings.h>
+
+namespace camera_aravis {
+
+    namespace {
+        // Layout of the compressed data: a header of 16 bytes (little endian), then the Rice codes of all samples
+        // in raster order as one bit stream, most significant bit first.
+        constexpr uint32_t MAGIC = 0x32315243;  // "CR12"
+        constexpr uint8_t VERSION = 1;
+        constexpr size_t HEADER_SIZE = 16;
+
+        constexpr int SAMPLE_BITS = 12;
+        constexpr uint32_t SAMPLE_MASK = (1u << SAMPLE_BITS) - 1;
+        // longer unary codes are replaced by an escape code followed by the plain residual
+        constexpr uint32_t RICE_LIMIT = 24;
+        // contexts per color: local gradient bins, plus one for the first rows and columns
+        constexpr int N_ACTIVITY = 8;
+        constexpr int N_CONTEXTS = N_ACTIVITY + 1;
+
+        enum Cfa : uint8_t { MONO = 0, RGGB, BGGR, GBRG, GRBG, N_CFA };
+
+        struct Format {
+            const char* pixel_format;
+            Cfa cfa;
+            bool gv_packed;  // GigE Vision 1.x "Packed" bit order instead of GenICam "p"
+        };
+
+        const Format FORMATS[] = {
+            {"Mono12p", MONO, false},          {"Mono12Packed", MONO, true},
+            {"BayerRG12p", RGGB, false},       {"BayerRG12Packed", RGGB, true},
+            {"BayerBG12p", BGGR, false},       {"BayerBG12Packed", BGGR, true},
+            {"BayerGB12p", GBRG, false},       {"BayerGB12Packed", GBRG, true},
+            {"BayerGR12p", GRBG, false},       {"BayerGR12Packed", GRBG, true},
+        };
+
+        const Format* find_format(const std::string& pixel_format) {
+            for (const Format& format : FORMATS) {
+                if (pixel_format == format.pixel_format) { return &format; }
+            }
+            return nullptr;
+        }
+
+        const std::string& decoded_encoding(Cfa cfa) {
+            namespace enc = sensor_msgs::image_encodings;
+            static const std::string encodings[N_CFA] = {enc::MONO16, enc::BAYER_RGGB16, enc::BAYER_BGGR16,
+                                                         enc::BAYER_GBRG16, enc::BAYER_GRBG16};
+            return encodings[cfa];
+        }
+
+        // Running mean of the coded values, which selects the Rice parameter (as in LOCO-I)
+        struct Context {
+            uint32_t sum = 16;
+            uint32_t count = 1;
+
+            // smallest k with count * 2^k >= sum; from the bit lengths it is one of two, no loop or division
+            int rice_parameter() const {
+                // the sum decays to zero on flat images
+                const int k = std::max(0, __builtin_clz(count) - __builtin_clz(sum | 1));
+                return std::min(SAMPLE_BITS, k + static_cast<int>((count << k) < sum));
+            }
+
+            void update(uint32_t value) {
+                sum += value;
+                if (++count == 64) {
+                    sum >>= 1;
+                    count >>= 1;
+                }
+            }
+        };
+
+        class BitWriter {
+            public:
+            BitWriter(std::vector<uint8_t>& data, size_t pos): data_(data), pos_(pos) {}
+
+            // Make room for n_bytes more
+            void reserve(size_t n_bytes) {
+                if (data_.size() < pos_ + n_bytes + 8) { data_.resize(std::max(2 * data_.size(), pos_ + n_bytes + 8)); }
+            }
+
+            // n_bits <= 32, value < 2^n_bits
+            void put(uint32_t value, int n_bits) {
+                bits_ = (bits_ << n_bits) | value;
+                n_bits_ += n_bits;
+                if (n_bits_ >= 32) {
+                    n_bits_ -= 32;
+                    const uint32_t word = static_cast<uint32_t>(bits_ >> n_bits_);
+                    data_[pos_] = word >> 24;
+                    data_[pos_ + 1] = word >> 16;
+                    data_[pos_ + 2] = word >> 8;
+                    data_[pos_ + 3] = word;
+                    pos_ += 4;
+                }
+            }
+
+            void put_rice(uint32_t value, int k) {
+                const uint32_t q = value >> k;
+                if (q >= RICE_LIMIT) {
+                    put(1, RICE_LIMIT + 1);
+                    put(value, SAMPLE_BITS);
+                } else if (q + 1 + k <= 32) {
+                    // q zeros, a one and the k low bits in one go
+                    put((1u << k) | (value & ((1u << k) - 1)), q + 1 + k);
+                } else {
+                    put(1, q + 1);
+                    put(value & ((1u << k) - 1), k);
+                }
+            }
+
+            // Flush the remaining bits and return the size of the data
+            size_t finish() {
+                reserve(8);
+                while (n_bits_ > 0) {
+                    const int shift = n_bits_ - 8;
+                    data_[pos_++] = static_cast<uint8_t>(shift >= 0 ? bits_ >> shift : bits_ << -shift);
+                    n_bits_ = std::max(0, shift);
+                }
+                return pos_;
+            }
+
+            private:
+            std::vector<uint8_t>& data_;
+            size_t pos_;
+            uint64_t bits_ = 0;
+            int n_bits_ = 0;
+        };
+
+        class BitReader {
+            public:
+            BitReader(const uint8_t* begin, const uint8_t* end): next_(begin), end_(end) {}
+
+            // Returns false on a code which cannot have been written by BitWriter
+            bool get_rice(int k, uint32_t& value) {
+                refill();
+                if (bits_ == 0) { return false; }
+                const uint32_t q = __builtin_clzll(bits_);
+                if (q > RICE_LIMIT) { return false; }
+                skip(q + 1);
+                if (q == RICE_LIMIT) {
+                    value = get(SAMPLE_BITS);
+                } else {
+                    value = (q << k) | get(k);
+                }
+                return true;
+            }
+
+            // Whether all bits read were in the data
+            bool ok() const { return n_padding_ * 8 <= static_cast<size_t>(n_bits_); }
+
+            private:
+            void refill() {
+                while (n_bits_ <= 56) {
+                    uint64_t byte = 0;
+                    if (next_ < end_) {
+                        byte = *next_++;
+                    } else {
+                        ++n_padding_;
+                    }
+                    bits_ |= byte << (56 - n_bits_);
+                    n_bits_ += 8;
+                }
+            }
+
+            // n_bits in [0, 32]
+            uint32_t get(int n_bits) {
+                if (n_bits_ < n_bits) { refill(); }
+                // two shifts, a shift by 64 would be undefined
+                const uint32_t res = static_cast<uint32_t>((bits_ >> 1) >> (63 - n_bits));
+                skip(n_bits);
+                return res;
+            }
+
+            void skip(int n_bits) {
+                bits_ <<= n_bits;
+                n_bits_ -= n_bits;
+            }
+
+            const uint8_t* next_;
+            const uint8_t* end_;
+            uint64_t bits_ = 0;  // left aligned
+            int n_bits_ = 0;
+            size_t n_padding_ = 0;  // zero bytes appended behind the end
+        };
+
+        inline uint32_t activity_bin(int activity) {
+            return activity == 0 ? 0 : std::min<uint32_t>(N_ACTIVITY - 1, 32 - __builtin_clz(activity));
+        }
+
+        // Visit the samples in raster order with their prediction and context, shared by encoder and decoder.
+        //
+        // Codec::begin_row(y, row) fills row if it encodes, Codec::code(sample, prediction, context) returns the
+        // sample, Codec::end_row(y, row) stores the row if it decodes; codec returns false to stop on an error.
+        template<typename Codec>
+        bool code_image(uint32_t width, uint32_t height, Cfa cfa, Codec& codec) {
+            // same color neighbors are two samples apart in a Bayer mosaic
+            const uint32_t d = cfa == MONO ? 1 : 2;
+            std::vector<uint16_t> rows(3 * width);
+            Context contexts[4 * N_CONTEXTS];
+
+            for (uint32_t y = 0; y < height; ++y) {
+                uint16_t* row = &rows[(y % 3) * width];
+                const uint16_t* up = y >= d ? &rows[((y - d) % 3) * width] : nullptr;
+                Context* row_contexts = cfa == MONO ? contexts : &contexts[(y & 1) * 2 * N_CONTEXTS];
+                if (!codec.begin_row(y, row)) { return false; }
+
+                for (uint32_t x = 0; x < width; ++x) {
+                    Context* color_contexts = cfa == MONO ? row_contexts : &row_contexts[(x & 1) * N_CONTEXTS];
+                    int prediction;
+                    Context* context;
+                    if (up && x >= d) {
+                        // median edge detector, i.e. the planar prediction clamped to the range of a and b
+                        const int a = row[x - d];
+                        const int b = up[x];
+                        const int c = up[x - d];
+                        prediction = std::clamp(a + b - c, std::min(a, b), std::max(a, b));
+                        context = &color_contexts[activity_bin(std::abs(a - c) + std::abs(b - c))];
+                    } else {
+                        prediction = up ? up[x] : x >= d ? row[x - d] : 1 << (SAMPLE_BITS - 1);
+                        context = &color_contexts[N_ACTIVITY];
+                    }
+                    row[x] = codec.code(row[x], prediction, *context);
+                }
+
+                if (!codec.end_row(y, row)) { return false; }
+            }
+            return true;
+        }
+
+        class Encoder {
+            public:
+            Encoder(const sensor_msgs::Image& image, const Format& format, BitWriter& writer):
+                image_(image), format_(format), writer_(writer) {}
+
+            bool begin_row(uint32_t y, uint16_t* row) {
+                // at most 37 bits per sample
+                writer_.reserve(5 * image_.width);
+
+                const uint8_t* from = image_.data.data() + y * image_.step;
+                if (format_.gv_packed) {
+                    // BBBBBBBB BBBBAAAA AAAAAAAA, byte 1 holds the low bits of both
+                    for (uint32_t x = 0; x < image_.width; x += 2, from += 3) {
+                        row[x] = (from[0] << 4) | (from[1] & 0x0f);
+                        row[x + 1] = (from[2] << 4) | (from[1] >> 4);
+                    }
+                } else {
+                    // BBBBBBBB BBBBAAAA AAAAAAAA, least significant bits first
+                    for (uint32_t x = 0; x < image_.width; x += 2, from += 3) {
+                        row[x] = from[0] | ((from[1] & 0x0f) << 8);
+                        row[x + 1] = (from[1] >> 4) | (from[2] << 4);
+                    }
+                }
+                return true;
+            }
+
+            uint16_t code(uint16_t sample, int prediction, Context& context) {
+                // residuals modulo 2^12 cover [-2048, 2047], zigzag mapped to [0, 4095]
+                const int residual = ((sample - prediction + 2048) & SAMPLE_MASK) - 2048;
+                const uint32_t value = residual >= 0 ? 2 * residual : -2 * residual - 1;
+                writer_.put_rice(value, context.rice_parameter());
+                context.update(value);
+                return sample;
+            }
+
+            bool end_row(uint32_t, const uint16_t*) { return true; }
+
+            private:
+            const sensor_msgs::Image& image_;
+            const Format& format_;
+            BitWriter& writer_;
+        };
+
+        class Decoder {
+            public:
+            Decoder(BitReader& reader, sensor_msgs::Image& image): reader_(reader), image_(image) {}
+
+            bool begin_row(uint32_t, uint16_t*) { return true; }
+
+            uint16_t code(uint16_t, int prediction, Context& context) {
+                uint32_t value = 0;
+                if (!reader_.get_rice(context.rice_parameter(), value)) { ok_ = false; }
+                context.update(value);
+                const int residual = value & 1 ? -static_cast<int>((value + 1) / 2) : static_cast<int>(value / 2);
+                return (prediction + residual) & SAMPLE_MASK;
+            }
+
+            bool end_row(uint32_t y, const uint16_t* row) {
+                // as unpacked by the driver: little endian, 12 bits in the most significant bits
+                uint8_t* to = image_.data.data() + y * image_.step;
+                for (uint32_t x = 0; x < image_.width; ++x, to += 2) {
+                    to[0] = static_cast<uint8_t>(row[x] << 4);
+                    to[1] = static_cast<uint8_t>(row[x] >> 4);
+                }
+                return ok_ && reader_.ok();
+            }
+
+            private:
+            BitReader& reader_;
+            sensor_msgs::Image& image_;
+            bool ok_ = true;
+        };
+
+        void put_u32(uint8_t* to, uint32_t value) {
+            for (int i = 0; i < 4; ++i) { to[i] = static_cast<uint8_t>(value >> (8 * i)); }
+        }
+
+        uint32_t get_u32(const uint8_t* from) {
+            uint32_t res = 0;
+            for (int i = 0; i < 4; ++i) { res |= static_cast<uint32_t>(from[i]) << (8 * i); }
+            return res;
+        }
+    }  // namespace
+
+    bool isRaw12Format(const std::string& pixel_format) { return find_format(pixel_format) != nullptr; }
+
+    bool encodeRaw12(const sensor_msgs::Image& image, std::vector<uint8_t>& data, std::string& error) {
+        const Format* format = find_format(image.encoding);
+        if (!format) {
+            error = "raw12 does not support " + image.encoding;
+            return false;
+        }
+        if (image.width % 2 != 0 || image.step < image.width / 2 * 3 ||
+            static_cast<size_t>(image.step) * image.height > image.data.size()) {
+            error = "inconsistent image size";
+            return false;
+        }
+
+        // most images fit in the packed size
+        data.resize(HEADER_SIZE + image.width / 2 * 3 * image.height);
+        put_u32(&data[0], MAGIC);
+        data[4] = VERSION;
+        data[5] = format->cfa;
+        data[6] = 0;
+        data[7] = 0;
+        put_u32(&data[8], image.width);
+        put_u32(&data[12], image.height);
+
+        BitWriter writer(data, HEADER_SIZE);
+        Encoder encoder(image, *format, writer);
+        code_image(image.width, image.height, format->cfa, encoder);
+        data.resize(writer.finish());
+        return true;
+    }
+
+    bool decodeRaw12(const sensor_msgs::CompressedImage& compressed, sensor_msgs::Image& image, std::string& error) {
+        const std::vector<uint8_t>& data = compressed.data;
+        if (data.size() < HEADER_SIZE || get_u32(&data[0]) != MAGIC || data[4] != VERSION || data[5] >= N_CFA) {
+            error = "not raw12 data";
+            return false;
+        }
+
+        const Cfa cfa = static_cast<Cfa>(data[5]);
+        const uint32_t width = get_u32(&data[8]);
+        const uint32_t height = get_u32(&data[12]);
+        // every sample takes at least one bit
+        if (width % 2 != 0 || static_cast<uint64_t>(width) * height > 8 * (data.size() - HEADER_SIZE)) {
+            error = "inconsistent raw12 image size";
+            return false;
+        }
+
+        image.header = compressed.header;
+        image.width = width;
+        image.height = height;
+        image.encoding = decoded_encoding(cfa);
+        image.is_bigendian = 0;
+        image.step = 2 * width;
+        image.data.resize(static_cast<size_t>(image.step) * height);
+
+        BitReader reader(data.data() + HEADER_SIZE, data.data() + data.size());
+        Decoder decoder(reader, image);
+        if (!code_image(width, height, cfa, decoder)) {
+            error = "corrupt raw12 data";
+            return false;
+        }
+        return true;
+    }
+
+}  // end namespace camera_aravis
@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ * camera_aravis
+ *
+ * Copyright © 2022 Fraunhofer IOSB and contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+
+
+// Restores the images a CameraAravisNodelet publishes on image_raw/raw12 (raw12_compression), e.g. when playing back
+// a bag recorded over a narrow link:
+//
+//   $ rosrun camera_aravis raw12_decoder raw12:=/camera/image_raw/raw12 image:=/camera/image_raw
+
+#include <string>
+
+#include <ros/ros.h>
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+
+#include <camera_aravis/raw12_codec.h>
+
+int main(int argc, char** argv) {
+    ros::init(argc, argv, "raw12_decoder");
+    ros::NodeHandle nh;
+
+    ros::Publisher publisher = nh.advertise<sensor_msgs::Image>("image", 10);
+    ros::Subscriber subscriber = nh.subscribe<sensor_msgs::CompressedImage>(
+        "raw12", 10, [&publisher](const sensor_msgs::CompressedImageConstPtr& compressed) {
+            sensor_msgs::ImagePtr image = boost::make_shared<sensor_msgs::Image>();
+            std::string error;
+            if (!camera_aravis::decodeRaw12(*compressed, *image, error)) {
+                ROS_WARN_THROTTLE(5.0, "Cannot decode %s: %s", compressed->format.c_str(), error.c_str());
+                return;
+            }
+            publisher.publish(image);
+        });
+
+    ros::spin();
+    return 0;
+}
@@ -0,0 +1,210 @@
+/****************************************************************************
+ *
+ * camera_aravis
+ *
+ * Copyright © 2022 Fraunhofer IOSB and contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+
+// Local benchmark of the shared memory image transport against TCPROS.
+//
+// One process publishes synthetic images both ways, like a CameraAravisNodelet with shm_transport, others receive
+// them out of process through one of the transports. Each receiver reads every byte of the images (as a consumer
+// would), and reports the latency from publishing to the callback and its own CPU load. See shm_benchmark.launch.
+//
+//   mode:=publish  width, height, rate
+//   mode:=shm      subscribes image_shm
+//   mode:=tcpros   subscribes image_raw
+
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include <camera_aravis/ShmImage.h>
+#include <camera_aravis/shm_image_subscriber.h>
+
+#include <camera_aravis_internal/shm_image_ring.h>
+
+namespace {
+
+    double process_cpu_s() {
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    // Latency and CPU load of a receiver, reported periodically
+    class Report {
+        public:
+        explicit Report(const std::string& transport): transport_(transport) { reset(); }
+
+        void record(const ros::Time& stamp, const uint8_t* data, size_t size) {
+            // read all of the image, the cost a consumer pays for the data to reach its cache
+            uint64_t sum = 0;
+            for (size_t i = 0; i < size; i += sizeof(uint64_t)) { sum += data[i]; }
+            checksum_ += sum;
+
+            const double latency = (ros::WallTime::now() - ros::WallTime(stamp.sec, stamp.nsec)).toSec();
+            latencies_.push_back(latency);
+            n_bytes_ += size;
+        }
+
+        void print(uint64_t n_missed) {
+            const double wall = (ros::WallTime::now() - begin_wall_).toSec();
+            const double cpu = process_cpu_s() - begin_cpu_;
+            if (latencies_.empty() || wall <= 0.0) {
+                ROS_INFO("%s: no images", transport_.c_str());
+                return;
+            }
+
+            std::sort(latencies_.begin(), latencies_.end());
+            double mean = 0.0;
+            for (double latency : latencies_) { mean += latency; }
+            mean /= latencies_.size();
+            const double p99 = latencies_[std::min(latencies_.size() - 1, latencies_.size() * 99 / 100)];
+
+            ROS_INFO("%s: %.1f Hz, %.1f MB/s, latency mean %.3f ms, p99 %.3f ms, max %.3f ms, CPU %.1f %%, "
+                     "%lu missed",
+                     transport_.c_str(), latencies_.size() / wall, n_bytes_ * 1e-6 / wall, mean * 1e3, p99 * 1e3,
+                     latencies_.back() * 1e3, cpu / wall * 1e2, static_cast<unsigned long>(n_missed));
+            reset();
+        }
+
+        private:
+        void reset() {
+            latencies_.clear();
+            n_bytes_ = 0;
+            begin_wall_ = ros::WallTime::now();
+            begin_cpu_ = process_cpu_s();
+        }
+
+        std::string transport_;
+        std::vector<double> latencies_;
+        uint64_t n_bytes_ = 0;
+        uint64_t checksum_ = 0;
+        ros::WallTime begin_wall_;
+        double begin_cpu_ = 0.0;
+    };
+
+    void publish(ros::NodeHandle& nh, ros::NodeHandle& pnh) {
+        const int width = pnh.param<int>("width", 1920);
+        const int height = pnh.param<int>("height", 1080);
+        const double rate = pnh.param<double>("rate", 30.0);
+        const int n_slots = pnh.param<int>("shm_slots", 8);
+
+        ros::Publisher image_publisher = nh.advertise<sensor_msgs::Image>("image_raw", 1);
+        ros::Publisher shm_publisher = nh.advertise<camera_aravis::ShmImage>("image_shm", 10);
+
+        sensor_msgs::Image image;
+        image.width = width;
+        image.height = height;
+        image.encoding = sensor_msgs::image_encodings::RGB8;
+        image.step = width * 3;
+        image.data.resize(image.step * height);
+
+        std::string error;
+        auto ring = camera_aravis::internal::ShmImageRing::create(
+            camera_aravis::internal::ShmImageRing::object_name(shm_publisher.getTopic()), n_slots, image.data.size(),
+            0600, error);
+        if (!ring) {
+            ROS_FATAL("Cannot create the shared memory ring: %s", error.c_str());
+            return;
+        }
+        ROS_INFO("Publishing %dx%d rgb8 at %.1f Hz, %.1f MB/s", width, height, rate,
+                 image.data.size() * rate * 1e-6);
+
+        ros::Rate loop(rate);
+        for (uint32_t seq = 0; ros::ok(); ++seq) {
+            // touch the image like a camera would
+            std::fill(image.data.begin(), image.data.end(), static_cast<uint8_t>(seq));
+            const ros::WallTime now = ros::WallTime::now();
+            image.header.seq = seq;
+            image.header.stamp = ros::Time(now.sec, now.nsec);
+
+            if (image_publisher.getNumSubscribers() > 0) { image_publisher.publish(image); }
+
+            uint32_t slot;
+            uint64_t sequence;
+            if (shm_publisher.getNumSubscribers() > 0 &&
+                ring->write(image.data.data(), image.data.size(), slot, sequence)) {
+                camera_aravis::ShmImage descriptor;
+                descriptor.header = image.header;
+                descriptor.width = image.width;
+                descriptor.height = image.height;
+                descriptor.encoding = image.encoding;
+                descriptor.step = image.step;
+                descriptor.region = ring->name();
+                descriptor.generation = ring->generation();
+                descriptor.slot = slot;
+                descriptor.sequence = sequence;
+                shm_publisher.publish(descriptor);
+            }
+
+            ros::spinOnce();
+            loop.sleep();
+        }
+    }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    ros::init(argc, argv, "shm_benchmark");
+    ros::NodeHandle nh;
+    ros::NodeHandle pnh("~");
+
+    const std::string mode = pnh.param<std::string>("mode", "publish");
+    const double report_period = pnh.param<double>("report_period", 5.0);
+
+    if (mode == "publish") {
+        publish(nh, pnh);
+        return 0;
+    }
+
+    Report report(mode);
+    ros::Subscriber image_subscriber;
+    std::unique_ptr<camera_aravis::ShmImageSubscriber> shm_subscriber;
+    if (mode == "shm") {
+        shm_subscriber = std::make_unique<camera_aravis::ShmImageSubscriber>(
+            nh, "image_shm", 10,
+            [&report](const camera_aravis::ShmImageConstPtr& image, const uint8_t* data, size_t size) {
+                report.record(image->header.stamp, data, size);
+            });
+    } else if (mode == "tcpros") {
+        image_subscriber = nh.subscribe<sensor_msgs::Image>(
+            "image_raw", 1,
+            [&report](const sensor_msgs::ImageConstPtr& image) {
+                report.record(image->header.stamp, image->data.data(), image->data.size());
+            },
+            ros::VoidConstPtr(), ros::TransportHints().tcpNoDelay());
+    } else {
+        ROS_FATAL("Unknown mode '%s' (publish, shm or tcpros)", mode.c_str());
+        return 1;
+    }
+
+    ros::WallTimer timer = nh.createWallTimer(ros::WallDuration(report_period), [&](const ros::WallTimerEvent&) {
+        report.print(shm_subscriber ? shm_subscriber->getNumMissed() : 0);
+    });
+    ros::spin();
+    return 0;
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+ *
+ * camera_aravis
+ *
+ * Copyright © 2022 Fraunhofer IOSB and contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ****************************************************************************/
+
+
+#include <camera_aravis/shm_image_subscriber.h>
+
+#include <camera_aravis_internal/shm_image_ring.h>
+
+namespace camera_aravis {
+
+    ShmImageSubscriber::ShmImageSubscriber(ros::NodeHandle& nh, const std::string& topic, uint32_t queue_size,
+                                           Callback callback):
+        callback_(std::move(callback)) {
+        subscriber_ = nh.subscribe(topic, queue_size, &ShmImageSubscriber::imageCallback, this,
+                                   ros::TransportHints().tcpNoDelay());
+    }
+
+    ShmImageSubscriber::~ShmImageSubscriber() { subscriber_.shutdown(); }
+
+    void ShmImageSubscriber::imageCallback(const ShmImageConstPtr& image) {
+        // the camera creates the ring anew when it restarts or the images grow
+        if (!ring_ || ring_->name() != image->region || ring_->generation() != image->generation) {
+            std::string error;
+            ring_ = internal::ShmImageRing::open(image->region, error);
+            if (!ring_) {
+                ROS_ERROR_THROTTLE(5.0, "Cannot map the images of %s: %s", subscriber_.getTopic().c_str(),
+                                   error.c_str());
+                ++n_missed_;
+                return;
+            }
+            if (ring_->generation() != image->generation) {
+                // descriptor of a ring replaced in the meantime
+                ring_.reset();
+                ++n_missed_;
+                return;
+            }
+        }
+
+        size_t size = 0;
+        const uint8_t* data = ring_->acquire(image->slot, image->sequence, size);
+        if (!data) {
+            ++n_missed_;
+            return;
+        }
+
+        ++n_received_;
+        try {
+            callback_(image, data, size);
+        } catch (...) {
+            ring_->release(image->slot);
+            throw;
+        }
+        ring_->release(image->slot);
+    }
+
+}  // namespace camera_aravis
@@ -0,0 +1,89 @@
+// Frames from the aravis fake camera through the buffer pool, which must hand all buffers back to the stream and,
+// once warmed up, must not allocate.
+//
+// The allocations are only counted with -DCAMERA_ARAVIS_HOTPATH_CHECKS=ON, which also replaces operator new of this
+// executable by the counting version of the library:
+//
+//   $ catkin_make run_tests_camera_aravis -DCAMERA_ARAVIS_HOTPATH_CHECKS=ON
+
+#include <deque>
+
+#include <gtest/gtest.h>
+
+#include <camera_aravis/camera_buffer_pool.h>
+#include <camera_aravis_internal/hotpath_checks.h>
+
+namespace camera_aravis {
+
+    namespace {
+        constexpr uint64_t WARMUP_FRAMES = 20;
+        constexpr int N_FRAMES = 200;
+    }  // namespace
+
+    TEST(CameraBufferPool, SteadyStateWithoutAllocations) {
+#ifdef CAMERA_ARAVIS_HOTPATH_CHECKS
+        internal::hotpath::Config config;
+        config.warmup_frames = WARMUP_FRAMES;
+        internal::hotpath::configure(config);
+#endif
+
+        arv_enable_interface("Fake");
+        GError* error = nullptr;
+        ArvCamera* camera = arv_camera_new("Fake_1", &error);
+        ASSERT_NE(nullptr, camera) << (error ? error->message : "no fake camera");
+        arv_camera_set_acquisition_mode(camera, ARV_ACQUISITION_MODE_CONTINUOUS, nullptr);
+        arv_camera_set_frame_rate(camera, 100.0, nullptr);
+
+        ArvStream* stream = arv_camera_create_stream(camera, nullptr, nullptr, &error);
+        ASSERT_NE(nullptr, stream) << (error ? error->message : "no stream");
+        const gint64 payload = arv_camera_get_payload(camera, nullptr);
+        ASSERT_GT(payload, 0);
+
+        {
+            CameraBufferPool::Ptr pool = boost::make_shared<CameraBufferPool>(stream, payload, 6);
+            arv_camera_start_acquisition(camera, nullptr);
+
+            // images still held by subscribers, released a few frames later as in the nodelet
+            std::deque<sensor_msgs::ImagePtr> held;
+            int n_frames = 0;
+            while (n_frames < N_FRAMES) {
+                ArvBuffer* buffer = arv_stream_timeout_pop_buffer(stream, 2000000);
+                ASSERT_NE(nullptr, buffer) << "no frame from the fake camera";
+                if (arv_buffer_get_status(buffer) != ARV_BUFFER_STATUS_SUCCESS) {
+                    arv_stream_push_buffer(stream, buffer);
+                    continue;
+                }
+
+                held.push_back((*pool)[buffer]);
+                // as a converted image
+                held.push_back(pool->getRecyclableImg());
+                while (held.size() > 4) { held.pop_front(); }
+
+                CA_HOTPATH_FRAME_DONE();
+                ++n_frames;
+            }
+
+            arv_camera_stop_acquisition(camera, nullptr);
+            held.clear();
+            EXPECT_EQ(0u, pool->getUsedSize());
+
+#ifdef CAMERA_ARAVIS_HOTPATH_CHECKS
+            const internal::hotpath::Statistics stats = internal::hotpath::get_statistics();
+            EXPECT_GE(stats.n_frames, static_cast<uint64_t>(N_FRAMES));
+            EXPECT_GT(stats.n_sections, 0u);
+            EXPECT_EQ(0u, stats.n_allocations);
+            EXPECT_EQ(0u, stats.n_violations);
+#endif
+
+            // the pool has to outlive the stream
+            g_object_unref(stream);
+        }
+        g_object_unref(camera);
+    }
+
+}  // namespace camera_aravis
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
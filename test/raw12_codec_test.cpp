@@ -0,0 +1,162 @@
+// Round trips of the raw12 codec through all packed formats it takes, and decoding of damaged data.
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <camera_aravis/raw12_codec.h>
+#include <sensor_msgs/image_encodings.h>
+
+namespace camera_aravis {
+
+    namespace {
+        constexpr uint32_t WIDTH = 64;
+        constexpr uint32_t HEIGHT = 48;
+
+        // Noise on a gradient, with a few samples at the ends of the range
+        std::vector<uint16_t> make_samples(uint32_t width, uint32_t height) {
+            std::vector<uint16_t> samples(width * height);
+            uint32_t state = 12345;
+            for (uint32_t y = 0; y < height; ++y) {
+                for (uint32_t x = 0; x < width; ++x) {
+                    state = state * 1664525u + 1013904223u;
+                    const int value = static_cast<int>(x * 40 + y * 20) + static_cast<int>(state >> 26) - 32;
+                    samples[y * width + x] = static_cast<uint16_t>(std::min(4095, std::max(0, value)));
+                }
+            }
+            samples[0] = 0;
+            samples[width + 1] = 4095;
+            samples.back() = 4095;
+            return samples;
+        }
+
+        // Pack the samples as the camera sends them, with step - width * 3 / 2 bytes of padding per row
+        sensor_msgs::Image pack(const std::vector<uint16_t>& samples, uint32_t width, uint32_t height, uint32_t step,
+                                const std::string& pixel_format) {
+            const bool gv_packed = pixel_format.find("Packed") != std::string::npos;
+            sensor_msgs::Image image;
+            image.encoding = pixel_format;
+            image.width = width;
+            image.height = height;
+            image.step = step;
+            image.data.assign(static_cast<size_t>(step) * height, 0xab);
+            for (uint32_t y = 0; y < height; ++y) {
+                uint8_t* to = image.data.data() + y * step;
+                for (uint32_t x = 0; x < width; x += 2, to += 3) {
+                    const uint16_t a = samples[y * width + x];
+                    const uint16_t b = samples[y * width + x + 1];
+                    if (gv_packed) {
+                        to[0] = static_cast<uint8_t>(a >> 4);
+                        to[1] = static_cast<uint8_t>((a & 0x0f) | ((b & 0x0f) << 4));
+                        to[2] = static_cast<uint8_t>(b >> 4);
+                    } else {
+                        to[0] = static_cast<uint8_t>(a);
+                        to[1] = static_cast<uint8_t>((a >> 8) | ((b & 0x0f) << 4));
+                        to[2] = static_cast<uint8_t>(b >> 4);
+                    }
+                }
+            }
+            return image;
+        }
+
+        sensor_msgs::CompressedImage encode(const sensor_msgs::Image& image) {
+            sensor_msgs::CompressedImage compressed;
+            std::string error;
+            EXPECT_TRUE(encodeRaw12(image, compressed.data, error)) << error;
+            return compressed;
+        }
+
+        void expect_round_trip(const std::string& pixel_format, const std::string& encoding, uint32_t step) {
+            SCOPED_TRACE(pixel_format);
+            const std::vector<uint16_t> samples = make_samples(WIDTH, HEIGHT);
+            const sensor_msgs::Image packed = pack(samples, WIDTH, HEIGHT, step, pixel_format);
+            ASSERT_TRUE(isRaw12Format(pixel_format));
+
+            sensor_msgs::Image image;
+            std::string error;
+            ASSERT_TRUE(decodeRaw12(encode(packed), image, error)) << error;
+            EXPECT_EQ(encoding, image.encoding);
+            ASSERT_EQ(WIDTH, image.width);
+            ASSERT_EQ(HEIGHT, image.height);
+            ASSERT_EQ(2 * WIDTH, image.step);
+            ASSERT_EQ(samples.size() * 2, image.data.size());
+            // little endian, 12 bits in the most significant bits
+            for (size_t i = 0; i < samples.size(); ++i) {
+                const uint16_t sample = image.data[2 * i] | (image.data[2 * i + 1] << 8);
+                ASSERT_EQ(samples[i] << 4, sample) << "at sample " << i;
+            }
+        }
+    }  // namespace
+
+    TEST(Raw12Codec, Mono12p) { expect_round_trip("Mono12p", sensor_msgs::image_encodings::MONO16, WIDTH / 2 * 3); }
+
+    TEST(Raw12Codec, Mono12Packed) {
+        expect_round_trip("Mono12Packed", sensor_msgs::image_encodings::MONO16, WIDTH / 2 * 3);
+    }
+
+    TEST(Raw12Codec, Bayer) {
+        namespace enc = sensor_msgs::image_encodings;
+        const std::pair<std::string, std::string> formats[] = {
+            {"BayerRG12", enc::BAYER_RGGB16},
+            {"BayerBG12", enc::BAYER_BGGR16},
+            {"BayerGB12", enc::BAYER_GBRG16},
+            {"BayerGR12", enc::BAYER_GRBG16},
+        };
+        for (const auto& format : formats) {
+            expect_round_trip(format.first + "p", format.second, WIDTH / 2 * 3);
+            expect_round_trip(format.first + "Packed", format.second, WIDTH / 2 * 3);
+        }
+    }
+
+    TEST(Raw12Codec, PaddedStep) {
+        expect_round_trip("Mono12p", sensor_msgs::image_encodings::MONO16, WIDTH / 2 * 3 + 7);
+        expect_round_trip("BayerRG12Packed", sensor_msgs::image_encodings::BAYER_RGGB16, WIDTH / 2 * 3 + 16);
+    }
+
+    TEST(Raw12Codec, RejectsInvalidImages) {
+        const std::vector<uint16_t> samples = make_samples(WIDTH, HEIGHT);
+        std::vector<uint8_t> data;
+        std::string error;
+
+        sensor_msgs::Image image = pack(samples, WIDTH, HEIGHT, WIDTH / 2 * 3, "Mono12p");
+        image.encoding = "Mono16";
+        EXPECT_FALSE(encodeRaw12(image, data, error));
+
+        image = pack(samples, WIDTH, HEIGHT, WIDTH / 2 * 3, "Mono12p");
+        image.data.resize(image.data.size() - 1);
+        EXPECT_FALSE(encodeRaw12(image, data, error));
+
+        image = pack(samples, WIDTH, HEIGHT, WIDTH / 2 * 3, "Mono12p");
+        image.width = WIDTH - 1;
+        EXPECT_FALSE(encodeRaw12(image, data, error));
+    }
+
+    TEST(Raw12Codec, TruncatedInput) {
+        const sensor_msgs::CompressedImage compressed =
+            encode(pack(make_samples(WIDTH, HEIGHT), WIDTH, HEIGHT, WIDTH / 2 * 3, "BayerGR12p"));
+        ASSERT_GT(compressed.data.size(), 16u);
+
+        sensor_msgs::Image image;
+        std::string error;
+        // empty, within the header, header only, and cut off at several points of the bit stream
+        const size_t sizes[] = {0, 8, 16, 17, compressed.data.size() / 2, compressed.data.size() - 8};
+        for (size_t size : sizes) {
+            sensor_msgs::CompressedImage truncated = compressed;
+            truncated.data.resize(size);
+            EXPECT_FALSE(decodeRaw12(truncated, image, error)) << "decoded " << size << " bytes";
+        }
+
+        sensor_msgs::CompressedImage corrupt = compressed;
+        corrupt.data[0] ^= 0xff;
+        EXPECT_FALSE(decodeRaw12(corrupt, image, error));
+    }
+
+}  // namespace camera_aravis
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}